@@ -0,0 +1,146 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef FSM_COVERAGE_H
+#define FSM_COVERAGE_H
+
+#include <vector>
+
+/*
+ * class template "fsm_coverage"
+ *   Counts the states and transitions of a state machine whose state
+ *   is held in a signal of an enum type T with values 0 .. states-1.
+ *   It needs no port: it is attached to the signal itself.
+ *
+ *   By default a sample is taken whenever the signal changes, so the
+ *   counts are entries into a state and transitions between different
+ *   states. If "sample" is given (e.g. the posedge_event() of the
+ *   clock), a sample is taken at every such event instead, so that
+ *   staying in a state is counted too; the signal is then read
+ *   before the update of that edge.
+ *
+ *   All counts are in one dense matrix with a row per state plus one
+ *   for the first sample, so a sample costs a single increment.
+ *   legal() declares the expected transitions; report() lists the
+ *   ones that were not covered and the unexpected ones.
+ */
+
+template <class T> class fsm_coverage : public sc_module {
+public:
+    SC_HAS_PROCESS(fsm_coverage);
+
+    fsm_coverage(sc_module_name name, const sc_signal_in_if<T>& state,
+                 unsigned states, const char* const* names = 0,
+                 const sc_event* sample = 0)
+      : sc_module(name), _state(state), _states(states), _names(names),
+        _count((states + 1) * states, 0), _legal(states * states, false),
+        _row(states * states)
+    {
+        SC_METHOD(main);
+        if (sample) {
+            sensitive << *sample;
+            dont_initialize();
+        } else
+            sensitive << state.value_changed_event();
+    }
+
+    void legal(unsigned from, unsigned to) {
+        _legal[from * _states + to] = true;
+    }
+
+    /* number of samples in "to" preceded by one in "from" */
+    unsigned long count(unsigned from, unsigned to) const {
+        return _count[from * _states + to];
+    }
+
+    void report(ostream& os) const;
+
+private:
+    const sc_signal_in_if<T>& _state;
+    unsigned _states;
+    const char* const* _names;
+    std::vector<unsigned long> _count;
+    std::vector<bool> _legal;
+    unsigned _row;	/* row of the previous sample */
+
+    void main() {
+        unsigned s = (unsigned) _state.read();
+        _count[_row + s]++;
+        _row = s * _states;
+    }
+
+    void name_of(ostream& os, unsigned s) const {
+        if (_names)
+            os << _names[s];
+        else
+            os << s;
+    }
+};
+
+template <class T> void
+fsm_coverage<T>::report(ostream& os) const
+{
+    unsigned visited = 0, covered = 0, expected = 0;
+
+    os << name() << ":" << endl;
+    for (unsigned s=0; s < _states; s++) {
+        unsigned long n = 0;
+        for (unsigned from=0; from <= _states; from++)
+            n += _count[from * _states + s];
+        os << "  ";
+        name_of(os, s);
+        os << ": " << n << endl;
+        if (n)
+            visited++;
+    }
+
+    for (unsigned from=0; from < _states; from++)
+        for (unsigned to=0; to < _states; to++) {
+            unsigned i = from * _states + to;
+            if (_legal[i]) {
+                expected++;
+                if (_count[i]) {
+                    covered++;
+                    continue;
+                }
+                os << "  not covered: ";
+            } else if (_count[i])
+                os << "  unexpected: ";
+            else
+                continue;
+            name_of(os, from);
+            os << " -> ";
+            name_of(os, to);
+            os << endl;
+        }
+
+    os << "  state coverage " << visited << "/" << _states;
+    if (expected)
+        os << ", transition coverage " << covered << "/" << expected;
+    os << endl;
+}
+
+#endif
@@ -0,0 +1,167 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef FSM_TABLE_H
+#define FSM_TABLE_H
+
+#include <assert.h>
+#include <vector>
+
+/*
+ * class template "fsm_table"
+ *   Transition table of a state machine with NI boolean inputs and
+ *   up to 32 boolean outputs. Inputs are packed into an input word
+ *   (bit i is input i), outputs into an output mask.
+ *
+ *   A transition leaves state "from" for state "to" when the input
+ *   bits selected by "care" equal "value"; it asserts the Mealy
+ *   outputs "outputs". The transitions of a state are tried in the
+ *   order they were added. If none matches, the state is kept.
+ *   Moore outputs of a state are asserted whenever it is current.
+ *
+ *   compile() evaluates all of this for every state and every input
+ *   word, so step() is one lookup in a dense table of
+ *   states * 2^NI entries.
+ */
+
+template <unsigned NI> class fsm_table {
+public:
+    enum { COMBINATIONS = 1 << NI };
+
+    struct entry {
+        unsigned	next;
+        unsigned	outputs;
+    };
+
+    fsm_table(unsigned states) : _states(states), _moore(states, 0) {}
+
+    void moore(unsigned state, unsigned outputs) {
+        assert(state < _states);
+        _moore[state] = outputs;
+    }
+
+    void transition(unsigned from, unsigned to, unsigned care,
+                    unsigned value, unsigned outputs = 0) {
+        assert(from < _states && to < _states);
+        transition_spec t = { from, to, care, value & care, outputs };
+        _spec.push_back(t);
+    }
+
+    void compile() {
+        _table.resize(_states * COMBINATIONS);
+        for (unsigned s=0; s < _states; s++)
+            for (unsigned x=0; x < COMBINATIONS; x++) {
+                entry& e = _table[s * COMBINATIONS + x];
+                e.next = s;
+                e.outputs = _moore[s];
+                for (unsigned k=0; k < _spec.size(); k++) {
+                    const transition_spec& t = _spec[k];
+                    if (t.from == s && (x & t.care) == t.value) {
+                        e.next = t.to;
+                        e.outputs |= t.outputs;
+                        break;
+                    }
+                }
+            }
+    }
+
+    const entry& step(unsigned state, unsigned inputs) const {
+        return _table[state * COMBINATIONS + inputs];
+    }
+
+private:
+    struct transition_spec {
+        unsigned	from, to;
+        unsigned	care, value;
+        unsigned	outputs;
+    };
+
+    unsigned _states;
+    std::vector<unsigned> _moore;
+    std::vector<transition_spec> _spec;
+    std::vector<entry> _table;
+};
+
+/*
+ * class "fsm_outputs"
+ *   Drives the outputs of a state machine from an output mask. Bit i
+ *   is bound to a port or signal with bind(i, ...); write() only
+ *   writes the outputs whose bit changed since the last write().
+ *   Outputs in "hold" are only ever set: once asserted, they keep
+ *   their value.
+ *   "initial" must match the initial values of the bound outputs.
+ */
+
+class fsm_outputs {
+public:
+    fsm_outputs(unsigned hold = 0, unsigned initial = 0)
+      : _hold(hold), _value(initial) {}
+
+    ~fsm_outputs() {
+        for (unsigned i=0; i < _out.size(); i++)
+            delete _out[i];
+    }
+
+    /* C is any port or channel with write(bool) */
+    template <class C> void bind(unsigned bit, C& c) {
+        if (_out.size() <= bit)
+            _out.resize(bit + 1, 0);
+        delete _out[bit];
+        _out[bit] = new output<C>(c);
+    }
+
+    void write(unsigned value) {
+        value |= _value & _hold;
+        unsigned changed = value ^ _value;
+        _value = value;
+        for (unsigned i=0; changed != 0; i++, changed >>= 1)
+            if ((changed & 1) && i < _out.size() && _out[i])
+                _out[i]->write((value >> i) & 1);
+    }
+
+    unsigned value() const { return _value; }
+
+private:
+    struct output_if {
+        virtual ~output_if() {}
+        virtual void write(bool v) = 0;
+    };
+
+    template <class C> struct output : output_if {
+        C& c;
+        output(C& c_) : c(c_) {}
+        void write(bool v) { c.write(v); }
+    };
+
+    unsigned _hold, _value;
+    std::vector<output_if*> _out;
+
+    /* owns the outputs; not copyable */
+    fsm_outputs(const fsm_outputs&);
+    fsm_outputs& operator=(const fsm_outputs&);
+};
+
+#endif
@@ -24,15 +24,727 @@
 //****************************************************************************
 
 
-
+#include <time.h>
 #include "systemc.h"
 #include "robot.h"
+#include "robot_levelized.h"
+#include "nat_types.h"
+#include "robot_model.h"
+#include "robot_x64.h"
+#include "fsm_coverage.h"
+
+/*
+ * Stimulus for robot_controller, either pseudo-random from a seed
+ * or read from a script. A script line is
+ *     <cycles> <reset> <useq_bus> <clrmrdy> <usw_zero>
+ * and applies these inputs for <cycles> clock cycles.
+ */
+
+class robot_stimulus
+{
+public:
+  robot_stimulus(unsigned seed) : _seed(seed ? seed : 1), _script(0), _repeat(0) {}
+  ~robot_stimulus() { if (_script) fclose(_script); }
+
+  bool open(const char* file) {
+    _script = fopen(file, "r");
+    return _script != 0;
+  }
+
+  // returns false at the end of the script
+  bool next(robot_inputs& in) {
+    if (_script)
+      return next_scripted(in);
+
+    // xorshift: cheap enough not to show up in the cycle rate
+    unsigned r = _seed;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    _seed = r;
+
+    in.reset = (r & 0x3ff) == 0;	// rare, so that long moves finish
+    in.clrmrdy = ((r >> 10) & 3) == 0;
+    in.sw_zero = ((r >> 12) & 7) == 0;
+    // mostly short distances
+    in.seq = (r >> 16) & (((r >> 15) & 3) == 0 ? 0xff : 0x0f);
+    return true;
+  }
+
+private:
+  unsigned _seed;
+  FILE* _script;
+  unsigned _repeat;
+  robot_inputs _in;
+
+  bool next_scripted(robot_inputs& in) {
+    while (_repeat == 0) {
+      unsigned cycles, reset, seq, clrmrdy, sw_zero;
+      int n = fscanf(_script, "%u %u %u %u %u",
+                     &cycles, &reset, &seq, &clrmrdy, &sw_zero);
+      if (n != 5)
+        return false;
+      _repeat = cycles;
+      _in.reset = reset != 0;
+      _in.seq = seq;
+      _in.clrmrdy = clrmrdy != 0;
+      _in.sw_zero = sw_zero != 0;
+    }
+    _repeat--;
+    in = _in;
+    return true;
+  }
+};
+
+/*
+ * The same distribution as robot_stimulus for 64 lanes, generated a
+ * word at a time: an input that is set with probability 2^-n is the
+ * AND of n random words.
+ */
+
+class robot_stimulus_x64
+{
+public:
+  robot_stimulus_x64(unsigned seed) : _seed(seed ? seed : 1) {}
+
+  void next(robot_inputs_x64& in) {
+    in.reset = random_and(10);
+    in.clrmrdy = random_and(2);
+    in.sw_zero = random_and(3);
+    uint64 wide = random_and(2);
+    for (unsigned i=0; i < 8; i++)
+      in.seq[i] = random() & (i < 4 ? ~(uint64) 0 : wide);
+  }
+
+private:
+  uint64 _seed;
+
+  uint64 random() {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    return _seed;
+  }
+
+  uint64 random_and(unsigned n) {
+    uint64 w = random();
+    while (--n)
+      w &= random();
+    return w;
+  }
+};
+
+/*
+ * Regression of 64 lanes with robot_x64, without the SystemC kernel.
+ * Every lane gets its own stimulus; the trace of every lane is
+ * compared (by signature) with that of robot_model on the same
+ * stimulus.
+ */
+
+int
+run_x64(unsigned long cycles, unsigned seed)
+{
+  robot_inputs_x64 in;
+
+  robot_stimulus_x64 stim(seed);
+  robot_x64 r;
+  trace_x64 trace;
+  clock_t t = clock();
+  for (unsigned long c=0; c < cycles; c++) {
+    stim.next(in);
+    r.comb(in);
+    r.posedge(in);
+    trace.add(r);
+  }
+  double seconds = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+  robot_stimulus_x64 ref_stim(seed);
+  robot_model m[64];
+  unsigned sig[64];
+  robot_inputs li;
+  for (unsigned lane=0; lane < 64; lane++)
+    sig[lane] = 0;
+  t = clock();
+  for (unsigned long c=0; c < cycles; c++) {
+    ref_stim.next(in);
+    for (unsigned lane=0; lane < 64; lane++) {
+      in.get(lane, li);
+      m[lane].comb(li);
+      m[lane].posedge(li);
+      sig[lane] = trace_sig(sig[lane], robot_x64::outputs(m[lane]));
+    }
+  }
+  double ref_seconds = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+  unsigned errors = 0;
+  for (unsigned lane=0; lane < 64; lane++)
+    if (trace.signature(lane) != sig[lane]) {
+      cout << "lane " << lane << ": signature " << hex << trace.signature(lane)
+           << ", expected " << sig[lane] << dec << endl;
+      errors++;
+    }
+
+  cout << "64 lanes x " << cycles << " cycles, " << errors << " lanes wrong" << endl;
+  if (seconds > 0)
+    cout << "  robot_x64:   " << 64 * cycles / seconds << " lane cycles/s" << endl;
+  if (ref_seconds > 0)
+    cout << "  robot_model: " << 64 * cycles / ref_seconds << " lane cycles/s" << endl;
+  return errors ? 1 : 0;
+}
+
+/*
+ * The table engine on a small machine: state 1 asserts Moore output
+ * 2, two transitions of state 1 overlap (the first one added wins),
+ * state 2 always leaves with Mealy output 4. Returns the number of
+ * wrong entries.
+ */
+
+static unsigned
+fsm_table_selftest()
+{
+  fsm_table<2> t(3);
+  t.moore(1, 2);
+  t.transition(0, 1, 1, 1, 1);
+  t.transition(1, 2, 2, 2);
+  t.transition(1, 0, 1, 1);
+  t.transition(2, 0, 0, 0, 4);
+  t.compile();
+
+  unsigned errors = 0;
+  for (unsigned s=0; s < 3; s++)
+    for (unsigned x=0; x < 4; x++) {
+      unsigned next = s, out = 0;
+      switch (s) {
+      case 0: if (x & 1) { next = 1; out = 1; } break;
+      case 1: out = 2; if (x & 2) next = 2; else if (x & 1) next = 0; break;
+      case 2: next = 0; out = 4; break;
+      }
+      if (t.step(s, x).next != next || t.step(s, x).outputs != out)
+        errors++;
+    }
+  return errors;
+}
+
+/*
+ * nat_uint<W> and nat_bv<W> against sc_uint<W> and sc_bv<W>: every
+ * operation of nat_types.h on the same pseudo-random values, bit
+ * positions and slices. sc_bv values are compared through sc_uint.
+ * Returns the number of differences.
+ */
+
+class nat_random
+{
+public:
+  nat_random() : _seed(((uint64) 0x9e3779b9 << 32) | 0x7f4a7c15) {}
+
+  uint64 next() {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    return _seed;
+  }
+
+  // below W
+  int index(int w) { return (int) (next() % (unsigned) w); }
+
+private:
+  uint64 _seed;
+};
+
+template <int W> static uint64
+sc_value(const sc_bv<W>& b)
+{
+  sc_uint<W> u;
+  u = b;
+  return u;
+}
+
+template <int W> static unsigned
+nat_uint_check(nat_random& r)
+{
+  unsigned errors = 0;
+  for (unsigned k=0; k < 1000; k++) {
+    uint64 a = r.next(), b = r.next() >> r.index(64);
+    int n = r.index(W), m = r.index(W);
+    int hi = n > m ? n : m, lo = n > m ? m : n;
+    bool bit = (r.next() & 1) != 0;
+
+    nat_uint<W> x(a), y(b), t;
+    sc_uint<W> u(a), v(b), s;
+    const nat_uint<W>& cx = x;
+    const sc_uint<W>& cu = u;
+
+    errors += (uint64) x != (uint64) u;
+    errors += x.to_uint64() != u.to_uint64();
+    errors += x.to_uint() != u.to_uint();
+    errors += x.to_int() != u.to_int();
+    errors += x.length() != u.length();
+
+    t = x + y;  s = u + v;  errors += (uint64) t != (uint64) s;
+    t = x - y;  s = u - v;  errors += (uint64) t != (uint64) s;
+    t = x * y;  s = u * v;  errors += (uint64) t != (uint64) s;
+    t = x & y;  s = u & v;  errors += (uint64) t != (uint64) s;
+    t = x | y;  s = u | v;  errors += (uint64) t != (uint64) s;
+    t = x ^ y;  s = u ^ v;  errors += (uint64) t != (uint64) s;
+    t = ~x;     s = ~u;     errors += (uint64) t != (uint64) s;
+    t = x << n; s = u << n; errors += (uint64) t != (uint64) s;
+    t = x >> n; s = u >> n; errors += (uint64) t != (uint64) s;
+
+    t = x; s = u; t += b;  s += b;  errors += (uint64) t != (uint64) s;
+    t = x; s = u; t -= b;  s -= b;  errors += (uint64) t != (uint64) s;
+    t = x; s = u; t *= b;  s *= b;  errors += (uint64) t != (uint64) s;
+    t = x; s = u; t &= b;  s &= b;  errors += (uint64) t != (uint64) s;
+    t = x; s = u; t |= b;  s |= b;  errors += (uint64) t != (uint64) s;
+    t = x; s = u; t ^= b;  s ^= b;  errors += (uint64) t != (uint64) s;
+    t = x; s = u; t <<= n; s <<= n; errors += (uint64) t != (uint64) s;
+    t = x; s = u; t >>= n; s >>= n; errors += (uint64) t != (uint64) s;
+
+    t = x; s = u; errors += (uint64) ++t != (uint64) ++s;
+    t = x; s = u; errors += (uint64) --t != (uint64) --s;
+    t = x; s = u; errors += (uint64) t++ != (uint64) s++;
+    errors += (uint64) t != (uint64) s;
+    t = x; s = u; errors += (uint64) t-- != (uint64) s--;
+    errors += (uint64) t != (uint64) s;
+
+    // bit selects and slices, read
+    errors += (bool) x[n] != (bool) u[n];
+    errors += x[n].to_bool() != u[n].to_bool();
+    errors += (bool) cx[n] != (bool) cu[n];
+    errors += (uint64) x.range(hi, lo) != (uint64) u.range(hi, lo);
+    errors += x(hi, lo).to_uint64() != u(hi, lo).to_uint64();
+    errors += cx.range(hi, lo) != (uint64) cu.range(hi, lo);
+    errors += cx(hi, lo) != (uint64) cu(hi, lo);
+
+    // and written
+    t = x; s = u; t[n] = bit; s[n] = bit;
+    errors += (uint64) t != (uint64) s;
+    t = x; s = u; t[n] = y[m]; s[n] = v[m];
+    errors += (uint64) t != (uint64) s;
+    t = x; s = u; t.range(hi, lo) = b; s.range(hi, lo) = b;
+    errors += (uint64) t != (uint64) s;
+    t = x; s = u; t(hi, lo) = b; s(hi, lo) = b;
+    errors += (uint64) t != (uint64) s;
+    t = x; s = u; t(hi, lo) = y(hi - lo, 0); s(hi, lo) = v(hi - lo, 0);
+    errors += (uint64) t != (uint64) s;
+  }
+  return errors;
+}
+
+template <int W> static unsigned
+nat_bv_check(nat_random& r)
+{
+  unsigned errors = 0;
+  for (unsigned k=0; k < 1000; k++) {
+    uint64 a = r.next(), b = r.next();
+    int n = r.index(W), m = r.index(W);
+    int hi = n > m ? n : m, lo = n > m ? m : n;
+    bool bit = (r.next() & 1) != 0;
+
+    nat_bv<W> x(a), y(b), t;
+    sc_bv<W> u, v, s;
+    u = sc_uint<W>(a);
+    v = sc_uint<W>(b);
+    const nat_bv<W>& cx = x;
+    const sc_bv<W>& cu = u;
+
+    errors += x.to_uint64() != sc_value(u);
+    errors += x.to_uint() != (unsigned) sc_value(u);
+    errors += x.length() != u.length();
+
+    t = ~x;     s = ~u;     errors += t.to_uint64() != sc_value(s);
+    t = x & y;  s = u & v;  errors += t.to_uint64() != sc_value(s);
+    t = x | y;  s = u | v;  errors += t.to_uint64() != sc_value(s);
+    t = x ^ y;  s = u ^ v;  errors += t.to_uint64() != sc_value(s);
+    t = x << n; s = u << n; errors += t.to_uint64() != sc_value(s);
+    t = x >> n; s = u >> n; errors += t.to_uint64() != sc_value(s);
+
+    t = x; s = u; t &= y; s &= v; errors += t.to_uint64() != sc_value(s);
+    t = x; s = u; t |= y; s |= v; errors += t.to_uint64() != sc_value(s);
+    t = x; s = u; t ^= y; s ^= v; errors += t.to_uint64() != sc_value(s);
+
+    errors += (x == y) != (u == v);
+    errors += (x != y) != (u != v);
+    t = x; s = u;
+    errors += (t == x) != (s == u);
+    errors += (t != x) != (s != u);
+
+    // bit selects and slices, read
+    errors += x[n].to_bool() != u[n].to_bool();
+    errors += cx[n].to_bool() != cu[n].to_bool();
+    s = u.range(hi, lo);
+    errors += x.range(hi, lo) != sc_value(s);
+    s = u(hi, lo);
+    errors += x(hi, lo).to_uint64() != sc_value(s);
+    s = cu(hi, lo);
+    errors += cx(hi, lo) != sc_value(s);
+
+    // and written
+    t = x; s = u; t[n] = bit; s[n] = bit;
+    errors += t.to_uint64() != sc_value(s);
+    t = x; s = u; t[n] = y[m]; s[n] = v[m];
+    errors += t.to_uint64() != sc_value(s);
+    t = x; s = u; t.range(hi, lo) = b; s.range(hi, lo) = sc_uint<64>(b);
+    errors += t.to_uint64() != sc_value(s);
+    t = x; s = u; t(hi, lo) = y(hi - lo, 0); s(hi, lo) = v(hi - lo, 0);
+    errors += t.to_uint64() != sc_value(s);
+  }
+  return errors;
+}
+
+static unsigned
+nat_types_selftest()
+{
+  nat_random r;
+  return nat_uint_check<1>(r) + nat_uint_check<8>(r) +
+         nat_uint_check<17>(r) + nat_uint_check<33>(r) +
+         nat_uint_check<64>(r) +
+         nat_bv_check<1>(r) + nat_bv_check<8>(r) + nat_bv_check<17>(r) +
+         nat_bv_check<33>(r) + nat_bv_check<64>(r);
+}
+
+/*
+ * Exhaustive check of ctrl_fsm: for every state and every input
+ * word, the original ctrl_fsm of robot_controller is simulated and
+ * its next state and outputs are compared with the table of
+ * robot_controller::compile_ctrl_table() and with ctrl_fsm_step().
+ * No clock edge ever comes, so after the initialization only
+ * ctrl_fsm runs; the state and DONE are written from here. That
+ * makes them signals with two writers, which only a kernel built
+ * with DEBUG_SYSTEMC reports. LDDIR is only ever set by ctrl_fsm,
+ * so it is cleared before every input word.
+ */
+
+class ctrl_fsm_check : public sc_module
+{
+public:
+  typedef robot_controller rc;
+  typedef fsm_table<rc::INPUTS> table_type;
+
+  SC_HAS_PROCESS(ctrl_fsm_check);
+
+  ctrl_fsm_check(sc_module_name name)
+    : sc_module(name), dut("dut"), _table(rc::MOVE + 1), _checked(0),
+      _errors(0)
+  {
+    SC_THREAD(main);
+
+    rc::compile_ctrl_table(_table);
+
+    dut.CLOCK(clock);
+    dut.RESET(reset);
+    dut.uSEQ_BUS(useq_bus);
+    dut.CLRMRDY(clrmrdy);
+    dut.uSW_ZERO(usw_zero);
+    dut.MRDY(mrdy);
+    dut.REPOS(repos);
+    dut.MAGNET(magnet);
+    dut.XY(xy);
+    dut.REVERSE(reverse);
+    dut.LDDIR(lddir);
+    dut.LSB_CNTR(lsb_cntr);
+  }
+
+  unsigned checked() const { return _checked; }
+  unsigned errors() const { return _errors; }
+
+  rc dut;
+  sc_signal<bool> clock, reset, clrmrdy, usw_zero;
+  sc_signal<sc_bv<8> > useq_bus;
+  sc_signal<bool> mrdy, repos, magnet, xy, reverse, lddir, lsb_cntr;
+
+private:
+  table_type _table;
+  unsigned _checked, _errors;
+
+  void main() {
+    wait(1, SC_NS);	// after the initialization of dut
+
+    for (unsigned s=rc::IDLE; s <= rc::MOVE; s++)
+      for (unsigned x=0; x < table_type::COMBINATIONS; x++) {
+        dut.curr_state.write((rc::ctrl_state) s);
+        dut.DONE.write((x & rc::IN_DONE) != 0);
+        reset.write((x & rc::IN_RESET) != 0);
+        mrdy.write((x & rc::IN_MRDY) != 0);
+        magnet.write((x & rc::IN_MAGNET) != 0);
+        repos.write((x & rc::IN_REPOS) != 0);
+        usw_zero.write((x & rc::IN_uSW_ZERO) != 0);
+        lddir.write(false);
+        wait(1, SC_NS);
+
+        unsigned next = dut.next_state.read();
+        unsigned out = (dut.LDDIST.read()  ? rc::OUT_LDDIST  : 0) |
+                       (dut.COUNT.read()   ? rc::OUT_COUNT   : 0) |
+                       (dut.LDINST.read()  ? rc::OUT_LDINST  : 0) |
+                       (dut.SETMRDY.read() ? rc::OUT_SETMRDY : 0) |
+                       (lddir.read()       ? rc::OUT_LDDIR   : 0);
+
+        const table_type::entry& e = _table.step(s, x);
+        compare("table", s, x, next, out, e.next, e.outputs);
+        unsigned step_next, step_out = ctrl_fsm_step(s, x, step_next);
+        compare("ctrl_fsm_step", s, x, next, out, step_next, step_out);
+        _checked++;
+      }
+    sc_stop();
+  }
+
+  void compare(const char* what, unsigned s, unsigned x, unsigned next,
+               unsigned out, unsigned got_next, unsigned got_out) {
+    if (got_next == next && got_out == out)
+      return;
+    if (_errors++ < 10)
+      cout << what << ", state " << s << ", inputs " << hex << x
+           << ": next " << dec << got_next << ", outputs " << hex << got_out
+           << " (ctrl_fsm: " << dec << next << ", " << hex << out << ")"
+           << dec << endl;
+  }
+};
+
+int
+run_table()
+{
+  unsigned selftest = fsm_table_selftest();
+  if (selftest)
+    cout << "fsm_table: " << selftest << " wrong entries" << endl;
+
+  unsigned nat = nat_types_selftest();
+  if (nat)
+    cout << "nat_types: " << nat << " differences" << endl;
+
+  unsigned cover = robot_x64::check_cover(cout);
+  if (cover)
+    cout << "robot_x64 cover: " << cover << " wrong outputs" << endl;
+
+  ctrl_fsm_check check("check");
+  sc_start(-1);
+  cout << check.checked() << " state/input combinations, " << check.errors()
+       << " wrong" << endl;
+  return selftest || nat || cover || check.errors() ? 1 : 0;
+}
+
+/*
+ * The output signals of a controller, and their comparison with
+ * robot_model
+ */
+
+struct robot_outputs
+{
+  sc_signal<bool> mrdy, repos, magnet, xy, reverse, lddir, lsb_cntr;
+
+  template <class C> void bind(C& c) {
+    c.MRDY(mrdy);
+    c.REPOS(repos);
+    c.MAGNET(magnet);
+    c.XY(xy);
+    c.REVERSE(reverse);
+    c.LDDIR(lddir);
+    c.LSB_CNTR(lsb_cntr);
+  }
+
+  bool match(const robot_model& m) const {
+    return mrdy.read() == m.mrdy && repos.read() == m.repos &&
+           magnet.read() == m.magnet && xy.read() == m.xy &&
+           reverse.read() == m.reverse && lddir.read() == m.lddir &&
+           lsb_cntr.read() == m.lsb_cntr;
+  }
+
+  void print(ostream& os) const {
+    os << "MRDY " << mrdy.read() << " REPOS " << repos.read()
+       << " MAGNET " << magnet.read() << " XY " << xy.read()
+       << " REVERSE " << reverse.read() << " LDDIR " << lddir.read()
+       << " LSB_CNTR " << lsb_cntr.read();
+  }
+};
+
+/*
+ * Testbench: one method generates the clock and the inputs. On the
+ * falling edge it compares the outputs of the controller (DUT is
+ * robot_controller or robot_controller_levelized) with the reference
+ * model and applies the next inputs, so the rising edge always sees
+ * stable inputs. With "table", a robot_controller with the table
+ * driven ctrl_fsm runs next to the DUT on the same inputs and is
+ * compared in the same way.
+ */
+
+static const char* state_names[] =
+  { "IDLE", "INST", "DIST", "RECAL", "DIR", "MOVE" };
+
+template <class DUT> class robot_tb : public sc_module
+{
+public:
+  enum { STATES = robot_controller::MOVE + 1 };
+
+  SC_HAS_PROCESS(robot_tb);
+
+  robot_tb(sc_module_name name, robot_stimulus& stim, unsigned long cycles,
+           bool table)
+    : sc_module(name), dut("dut"), table_dut(0),
+      coverage("coverage", dut.curr_state, STATES, state_names,
+               &clock.posedge_event()),
+      _stim(stim), _cycles(cycles), _cycle(0), _rising(false), _errors(0),
+      _half_period(0.5, SC_NS)
+  {
+    SC_METHOD(tick);
+
+    connect(dut, out);
+    if (table) {
+      table_dut = new robot_controller("table_dut", true);
+      connect(*table_dut, table_out);
+    }
+
+    // the transitions of ctrl_fsm; RESET adds any state -> IDLE
+    static const bool legal[STATES][STATES] = {
+      /*          IDLE   INST   DIST   RECAL  DIR    MOVE  */
+      /* IDLE  */ { true,  true,  false, false, false, false },
+      /* INST  */ { true,  false, true,  true,  false, false },
+      /* DIST  */ { true,  false, true,  false, true,  false },
+      /* RECAL */ { true,  false, false, true,  false, false },
+      /* DIR   */ { true,  false, false, false, false, true  },
+      /* MOVE  */ { true,  false, false, false, false, true  },
+    };
+    for (unsigned i=0; i < STATES; i++)
+      for (unsigned j=0; j < STATES; j++)
+        if (legal[i][j])
+          coverage.legal(i, j);
+  }
+
+  ~robot_tb() { delete table_dut; }
+
+  unsigned long cycles() const { return _cycle; }
+  unsigned long errors() const { return _errors; }
+
+  DUT dut;
+  robot_controller* table_dut;
+  sc_signal<bool> clock, reset, clrmrdy, usw_zero;
+  sc_signal<sc_bv<8> > useq_bus;
+  robot_outputs out, table_out;
+
+  // samples the state once per cycle
+  fsm_coverage<robot_controller::ctrl_state> coverage;
+
+private:
+  robot_stimulus& _stim;
+  unsigned long _cycles, _cycle;
+  bool _rising;
+  unsigned long _errors;
+  sc_time _half_period;
+  robot_inputs _in;
+  robot_model _model;
+
+  template <class C> void connect(C& c, robot_outputs& o) {
+    c.CLOCK(clock);
+    c.RESET(reset);
+    c.uSEQ_BUS(useq_bus);
+    c.CLRMRDY(clrmrdy);
+    c.uSW_ZERO(usw_zero);
+    o.bind(c);
+  }
+
+  void tick() {
+    if (_rising) {
+      clock.write(true);
+      _cycle++;
+    } else {
+      if (_cycle > 0) {
+        _model.posedge(_in);
+        check("dut", dut.curr_state.read(), out);
+        if (table_dut)
+          check("table_dut", table_dut->curr_state.read(), table_out);
+      }
+      if (_cycle == _cycles || !_stim.next(_in)) {
+        sc_stop();
+        return;
+      }
+      _model.comb(_in);
+
+      reset.write(_in.reset);
+      useq_bus.write(sc_bv<8>((int) _in.seq));
+      clrmrdy.write(_in.clrmrdy);
+      usw_zero.write(_in.sw_zero);
+      clock.write(false);
+    }
+    _rising = !_rising;
+    next_trigger(_half_period);
+  }
+
+  void check(const char* who, robot_model::ctrl_state s,
+             const robot_outputs& o) {
+    if (s == _model.curr_state && o.match(_model))
+      return;
+
+    if (_errors++ < 10) {
+      cout << "cycle " << _cycle << ", " << who << ": state " << s
+           << " (expected " << _model.curr_state << "), ";
+      o.print(cout);
+      cout << " (expected " << _model.mrdy << " " << _model.repos << " "
+           << _model.magnet << " " << _model.xy << " " << _model.reverse
+           << " " << _model.lddir << " " << _model.lsb_cntr << ")" << endl;
+    }
+  }
+};
+
+template <class DUT> int
+run(robot_stimulus& stim, unsigned long cycles, bool table)
+{
+  robot_tb<DUT> tb("tb", stim, cycles, table);
+
+  clock_t t = clock();
+  sc_start(-1);
+  double seconds = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+  cout << tb.cycles() << " cycles, " << tb.errors() << " errors";
+  if (seconds > 0)
+    cout << ", " << tb.cycles() / seconds << " cycles/s";
+  cout << endl;
+  tb.coverage.report(cout);
+
+  return tb.errors() ? 1 : 0;
+}
+
+// usage: run.x [-c|-x] [cycles [seed]]
+//        run.x [-c] -f script
+//        run.x -t
+//   Without option, robot_controller is simulated next to a
+//   robot_controller with the table driven ctrl_fsm
+//   -c simulates the hand-levelized robot_controller_levelized alone
+//   -x runs 64 lanes of robot_x64 instead of a simulation
+//   -t compares the ctrl_fsm table and ctrl_fsm_step() with ctrl_fsm
+//      for every state and input word, ROBOT_X64_COVER with
+//      ctrl_fsm_step(), and nat_types.h with sc_uint and sc_bv
 
 int
 sc_main(int argc, char *argv[])
 {
+  unsigned long cycles = 1000000;
+  unsigned seed = 1;
+  if (argc > 1 && strcmp(argv[1], "-t") == 0)
+    return run_table();
+
+  bool cycle_based = argc > 1 && strcmp(argv[1], "-c") == 0;
+  bool x64 = argc > 1 && strcmp(argv[1], "-x") == 0;
+  if (cycle_based || x64) {
+    argc--;
+    argv++;
+  }
+  bool scripted = argc > 2 && strcmp(argv[1], "-f") == 0;
+
+  if (!scripted) {
+    if (argc > 1) cycles = strtoul(argv[1], 0, 10);
+    if (argc > 2) seed = atoi(argv[2]);
+  }
+
+  if (x64)
+    return run_x64(cycles, seed);
 
-  // Still to do: instantiate robot_controller module and create testbench
+  robot_stimulus stim(seed);
+  if (scripted) {
+    if (!stim.open(argv[2])) {
+      cerr << "cannot open " << argv[2] << endl;
+      return 1;
+    }
+    cycles = (unsigned long) -1;
+  }
 
-  return 0;
+  if (cycle_based)
+    return run<robot_controller_levelized>(stim, cycles, false);
+  return run<robot_controller>(stim, cycles, true);
 }
@@ -0,0 +1,230 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef NAT_TYPES_H
+#define NAT_TYPES_H
+
+#include "systemc.h"
+
+/*
+ * nat_uint<W> and nat_bv<W>: stand-ins for sc_uint<W> and sc_bv<W>
+ * for 1 <= W <= 64, stored in the smallest native unsigned integer
+ * that holds W bits. Bit selects, slices and conversions are inline
+ * shifts and masks instead of the generic proxies of the SystemC
+ * data-types, and the values are always kept masked to W bits.
+ *
+ *   x[i], x.bit(i)              bit select, also assignable
+ *   x.range(hi, lo), x(hi, lo)  slice, also assignable
+ *   x.to_uint(), x.to_int(), x.to_uint64(), x.length()
+ *
+ * nat_uint converts implicitly to uint64 like sc_uint does, so it
+ * takes part in integer arithmetic; nat_bv only has the bitwise
+ * operators, like sc_bv. Both can be traced with sc_trace().
+ *
+ * The types belong to the robot example: robot_controller_levelized
+ * keeps its registers in them, while its ports stay sc_uint and
+ * sc_bv. They cover only what it needs and are not a replacement for
+ * the SystemC data-types elsewhere. "run.x -t" compares every
+ * operation with sc_uint and sc_bv at widths 1, 8, 17, 33 and 64.
+ */
+
+template <int N> struct nat_storage { typedef uint64 type; };
+template <> struct nat_storage<1> { typedef unsigned int type; };
+template <> struct nat_storage<2> { typedef unsigned short type; };
+template <> struct nat_storage<3> { typedef unsigned char type; };
+
+template <class B> class nat_bitref {
+public:
+    nat_bitref(B& b, int i) : _b(b), _i(i) {}
+
+    operator bool() const { return _b.bit(_i); }
+    bool to_bool() const { return _b.bit(_i); }
+
+    nat_bitref& operator=(bool v) {
+        _b.set_bit(_i, v);
+        return *this;
+    }
+
+    nat_bitref& operator=(const nat_bitref& r) { return *this = (bool) r; }
+
+private:
+    B& _b;
+    int _i;
+};
+
+template <class B> class nat_rangeref {
+public:
+    nat_rangeref(B& b, int hi, int lo) : _b(b), _hi(hi), _lo(lo) {}
+
+    operator uint64() const { return _b.get_range(_hi, _lo); }
+    uint64 to_uint64() const { return _b.get_range(_hi, _lo); }
+    unsigned to_uint() const { return (unsigned) _b.get_range(_hi, _lo); }
+
+    nat_rangeref& operator=(uint64 v) {
+        _b.set_range(_hi, _lo, v);
+        return *this;
+    }
+
+    nat_rangeref& operator=(const nat_rangeref& r) { return *this = (uint64) r; }
+
+private:
+    B& _b;
+    int _hi, _lo;
+};
+
+template <int W> class nat_bits {
+public:
+    typedef typename nat_storage<(W <= 8) + (W <= 16) + (W <= 32)>::type
+        value_type;
+
+    static uint64 mask() { return ~(uint64) 0 >> (64 - W); }
+
+    nat_bits() : _v(0) {}
+    nat_bits(uint64 v) : _v((value_type) (v & mask())) {}
+
+    int length() const { return W; }
+
+    bool bit(int i) const { return (_v >> i) & 1; }
+
+    void set_bit(int i, bool b) {
+        value_type m = (value_type) ((uint64) 1 << i);
+        _v = b ? (value_type) (_v | m) : (value_type) (_v & ~m);
+    }
+
+    uint64 get_range(int hi, int lo) const {
+        return ((uint64) _v >> lo) & (~(uint64) 0 >> (63 - hi + lo));
+    }
+
+    void set_range(int hi, int lo, uint64 v) {
+        uint64 m = (~(uint64) 0 >> (63 - hi + lo)) << lo;
+        _v = (value_type) (((uint64) _v & ~m) | ((v << lo) & m));
+    }
+
+    uint64 to_uint64() const { return _v; }
+    unsigned to_uint() const { return (unsigned) _v; }
+    int to_int() const { return (int) _v; }
+
+    const value_type& value() const { return _v; }
+
+protected:
+    value_type _v;
+};
+
+template <int W> class nat_uint : public nat_bits<W> {
+public:
+    typedef nat_bitref<nat_uint> bitref;
+    typedef nat_bitref<const nat_uint> const_bitref;
+    typedef nat_rangeref<nat_uint> rangeref;
+
+    nat_uint() {}
+    nat_uint(uint64 v) : nat_bits<W>(v) {}
+
+    operator uint64() const { return this->_v; }
+
+    const_bitref operator[](int i) const { return const_bitref(*this, i); }
+    bitref operator[](int i) { return bitref(*this, i); }
+
+    uint64 range(int hi, int lo) const { return this->get_range(hi, lo); }
+    rangeref range(int hi, int lo) { return rangeref(*this, hi, lo); }
+    uint64 operator()(int hi, int lo) const { return this->get_range(hi, lo); }
+    rangeref operator()(int hi, int lo) { return rangeref(*this, hi, lo); }
+
+    nat_uint& operator+=(uint64 v) { return *this = *this + v; }
+    nat_uint& operator-=(uint64 v) { return *this = *this - v; }
+    nat_uint& operator*=(uint64 v) { return *this = *this * v; }
+    nat_uint& operator&=(uint64 v) { return *this = *this & v; }
+    nat_uint& operator|=(uint64 v) { return *this = *this | v; }
+    nat_uint& operator^=(uint64 v) { return *this = *this ^ v; }
+    nat_uint& operator<<=(int n) { return *this = (uint64) *this << n; }
+    nat_uint& operator>>=(int n) { return *this = (uint64) *this >> n; }
+
+    nat_uint& operator++() { return *this = *this + 1; }
+    nat_uint& operator--() { return *this = *this - 1; }
+    nat_uint operator++(int) { nat_uint t = *this; ++*this; return t; }
+    nat_uint operator--(int) { nat_uint t = *this; --*this; return t; }
+};
+
+template <int W> class nat_bv : public nat_bits<W> {
+public:
+    typedef nat_bitref<nat_bv> bitref;
+    typedef nat_bitref<const nat_bv> const_bitref;
+    typedef nat_rangeref<nat_bv> rangeref;
+
+    nat_bv() {}
+    nat_bv(uint64 v) : nat_bits<W>(v) {}
+
+    const_bitref operator[](int i) const { return const_bitref(*this, i); }
+    bitref operator[](int i) { return bitref(*this, i); }
+
+    uint64 range(int hi, int lo) const { return this->get_range(hi, lo); }
+    rangeref range(int hi, int lo) { return rangeref(*this, hi, lo); }
+    uint64 operator()(int hi, int lo) const { return this->get_range(hi, lo); }
+    rangeref operator()(int hi, int lo) { return rangeref(*this, hi, lo); }
+
+    nat_bv operator~() const { return nat_bv(~(uint64) this->_v); }
+    nat_bv operator&(const nat_bv& b) const { return nat_bv(this->_v & b._v); }
+    nat_bv operator|(const nat_bv& b) const { return nat_bv(this->_v | b._v); }
+    nat_bv operator^(const nat_bv& b) const { return nat_bv(this->_v ^ b._v); }
+    nat_bv operator<<(int n) const { return nat_bv((uint64) this->_v << n); }
+    nat_bv operator>>(int n) const { return nat_bv((uint64) this->_v >> n); }
+
+    nat_bv& operator&=(const nat_bv& b) { return *this = *this & b; }
+    nat_bv& operator|=(const nat_bv& b) { return *this = *this | b; }
+    nat_bv& operator^=(const nat_bv& b) { return *this = *this ^ b; }
+
+    bool operator==(const nat_bv& b) const { return this->_v == b._v; }
+    bool operator!=(const nat_bv& b) const { return this->_v != b._v; }
+};
+
+template <int W> inline ostream&
+operator<<(ostream& os, const nat_uint<W>& v)
+{
+    return os << v.to_uint64();
+}
+
+template <int W> inline ostream&
+operator<<(ostream& os, const nat_bv<W>& v)
+{
+    for (int i=W-1; i >= 0; i--)
+        os << (v[i] ? '1' : '0');
+    return os;
+}
+
+/* traced as a W-bit vector, like sc_uint<W> and sc_bv<W> */
+
+template <int W> inline void
+sc_trace(sc_trace_file* tf, const nat_uint<W>& v, const sc_string& name)
+{
+    sc_trace(tf, v.value(), name, W);
+}
+
+template <int W> inline void
+sc_trace(sc_trace_file* tf, const nat_bv<W>& v, const sc_string& name)
+{
+    sc_trace(tf, v.value(), name, W);
+}
+
+#endif
@@ -67,6 +67,42 @@ robot_controller::ctrl_fsm_state()
     curr_state.write(next_state.read());
 }
 
+/* the transitions of ctrl_fsm() below, in the same order */
+
+void
+robot_controller::compile_ctrl_table(fsm_table<INPUTS>& t)
+{
+    for (unsigned s=IDLE; s <= MOVE; s++)
+        t.transition(s, IDLE, IN_RESET, IN_RESET);
+
+    t.transition(IDLE,  INST,  IN_MRDY, 0, OUT_LDINST);
+    t.transition(INST,  IDLE,  IN_MAGNET, IN_MAGNET, OUT_SETMRDY);
+    t.transition(INST,  RECAL, IN_REPOS, IN_REPOS, OUT_LDDIR);
+    t.transition(INST,  DIST,  0, 0, OUT_SETMRDY);
+    t.transition(RECAL, IDLE,  IN_uSW_ZERO, IN_uSW_ZERO, OUT_SETMRDY);
+    t.transition(RECAL, RECAL, 0, 0, OUT_COUNT);
+    t.transition(DIST,  DIR,   IN_MRDY, 0, OUT_LDDIST);
+    t.transition(DIR,   MOVE,  0, 0, OUT_LDDIR);
+    t.transition(MOVE,  IDLE,  IN_DONE, IN_DONE, OUT_SETMRDY);
+    t.transition(MOVE,  MOVE,  0, 0, OUT_COUNT);
+    t.compile();
+}
+
+void
+robot_controller::ctrl_fsm_table()
+{
+    unsigned in = (RESET.read()    ? IN_RESET    : 0) |
+                  (MRDY.read()     ? IN_MRDY     : 0) |
+                  (MAGNET.read()   ? IN_MAGNET   : 0) |
+                  (REPOS.read()    ? IN_REPOS    : 0) |
+                  (uSW_ZERO.read() ? IN_uSW_ZERO : 0) |
+                  (DONE.read()     ? IN_DONE     : 0);
+
+    const fsm_table<INPUTS>::entry& e = ctrl_table.step(curr_state.read(), in);
+    ctrl_outputs.write(e.outputs);
+    next_state.write((ctrl_state) e.next);
+}
+
 void
 robot_controller::ctrl_fsm()
 {
@@ -129,4 +165,3 @@ robot_controller::ctrl_fsm()
     }
     next_state.write(ns);
 }
-
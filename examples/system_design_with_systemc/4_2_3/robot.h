@@ -27,6 +27,8 @@
 #ifndef ROBOT_H
 #define ROBOT_H
 
+#include "fsm_table.h"
+
 SC_MODULE(robot_controller) {
 
     sc_in<bool>		CLOCK;
@@ -50,20 +52,48 @@ SC_MODULE(robot_controller) {
     sc_uint<8> counter;
     sc_signal<bool> LDINST, SETMRDY;
 
+    /* inputs and outputs of ctrl_fsm as bits of a word */
+    enum { IN_RESET = 1, IN_MRDY = 2, IN_MAGNET = 4, IN_REPOS = 8,
+           IN_uSW_ZERO = 16, IN_DONE = 32, INPUTS = 6 };
+    enum { OUT_LDDIST = 1, OUT_COUNT = 2, OUT_LDINST = 4, OUT_SETMRDY = 8,
+           OUT_LDDIR = 16, OUTPUTS = 5 };
+
+    /* the transitions of ctrl_fsm, compiled into a table */
+    static void compile_ctrl_table(fsm_table<INPUTS>& t);
+
+    /* used by ctrl_fsm_table() */
+    fsm_table<INPUTS> ctrl_table;
+    fsm_outputs ctrl_outputs;
+
     /* member function prototypes */
     void counter_proc();
     void inst_reg_proc();
     void mrdy_proc();
     void ctrl_fsm_state();
     void ctrl_fsm();
+    void ctrl_fsm_table();
 
-    /* Constructor */
-    SC_CTOR(robot_controller) {
+    /* Constructor; with "table", ctrl_fsm is done by ctrl_fsm_table()
+       with the same sensitivity */
+    SC_HAS_PROCESS(robot_controller);
+    robot_controller(sc_module_name name, bool table = false)
+      : sc_module(name), ctrl_table(MOVE + 1), ctrl_outputs(OUT_LDDIR)
+    {
         SC_METHOD(counter_proc);	sensitive << CLOCK.pos();
         SC_METHOD(inst_reg_proc);	sensitive << CLOCK.pos();
         SC_METHOD(mrdy_proc);		sensitive << CLOCK.pos();
 	SC_METHOD(ctrl_fsm_state);	sensitive << CLOCK.pos();
-        SC_METHOD(ctrl_fsm);
+        if (table) {
+            compile_ctrl_table(ctrl_table);
+            ctrl_outputs.bind(0, LDDIST);
+            ctrl_outputs.bind(1, COUNT);
+            ctrl_outputs.bind(2, LDINST);
+            ctrl_outputs.bind(3, SETMRDY);
+            ctrl_outputs.bind(4, LDDIR);	/* only ever set */
+            SC_METHOD(ctrl_fsm_table);
+        } else {
+            SC_METHOD(ctrl_fsm);
+        }
             sensitive << RESET << REPOS << MAGNET
                       << DONE << uSW_ZERO << MRDY << curr_state;
     }
@@ -0,0 +1,105 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#include "systemc.h"
+#include "robot.h"
+#include "robot_levelized.h"
+#include "robot_model.h"
+
+void
+robot_controller_levelized::edge()
+{
+    /* level 0, on the values before the edge */
+
+    if (_lddist) {					/* counter_proc */
+        _counter = uSEQ_BUS.read().to_uint();
+    } else if (_count) {
+        _counter = _counter - 1;
+    }
+
+    if (_ldinst) {					/* inst_reg_proc */
+        nat_bv<4>  inst = uSEQ_BUS.read().to_uint();
+        _repos   = inst[0].to_bool();
+        _magnet  = inst[1].to_bool();
+        _xy      = inst[2].to_bool();
+        _reverse = inst[3].to_bool();
+    }
+
+    if (CLRMRDY.read()) {				/* mrdy_proc */
+        _mrdy = false;
+    } else if (_setmrdy) {
+        _mrdy = true;
+    }
+
+    _curr = _next;					/* ctrl_fsm_state */
+
+    /* level 1, on the values after the edge */
+
+    ctrl_fsm();
+
+    /* outputs; writing an unchanged value causes no event */
+
+    LSB_CNTR.write(_counter[0]);
+    REPOS.write(_repos);
+    MAGNET.write(_magnet);
+    XY.write(_xy);
+    REVERSE.write(_reverse);
+    MRDY.write(_mrdy);
+    curr_state.write(_curr);
+}
+
+void
+robot_controller_levelized::inputs()
+{
+    ctrl_fsm();
+}
+
+void
+robot_controller_levelized::ctrl_fsm()
+{
+    typedef robot_controller rc;
+    unsigned in = (RESET.read()    ? rc::IN_RESET    : 0) |
+                  (_mrdy           ? rc::IN_MRDY     : 0) |
+                  (_magnet         ? rc::IN_MAGNET   : 0) |
+                  (_repos          ? rc::IN_REPOS    : 0) |
+                  (uSW_ZERO.read() ? rc::IN_uSW_ZERO : 0) |
+                  (_counter == 0   ? rc::IN_DONE     : 0);
+    unsigned ns;
+    unsigned out = ctrl_fsm_step(_curr, in, ns);
+
+    _next = (ctrl_state) ns;
+    _lddist  = (out & rc::OUT_LDDIST) != 0;
+    _count   = (out & rc::OUT_COUNT) != 0;
+    _ldinst  = (out & rc::OUT_LDINST) != 0;
+    _setmrdy = (out & rc::OUT_SETMRDY) != 0;
+
+    /* like the original, LDDIR is only ever set */
+    if (out & rc::OUT_LDDIR) {
+        _lddir = true;
+        LDDIR.write(true);
+    }
+    next_state.write(_next);
+}
@@ -0,0 +1,107 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef ROBOT_LEVELIZED_H
+#define ROBOT_LEVELIZED_H
+
+#include "nat_types.h"
+
+/*
+ * Hand-levelized version of robot_controller, with the same ports
+ * and the same values on them at every clock edge. The evaluation
+ * order below was worked out by hand from the static sensitivity of
+ * the processes of robot_controller; it is not derived from it, so
+ * a change to robot_controller has to be repeated here ("run.x -c"
+ * compares the two through robot_model).
+ *
+ * The processes of robot_controller fall into two levels:
+ *   level 0 - counter_proc, inst_reg_proc, mrdy_proc and
+ *             ctrl_fsm_state are sensitive to CLOCK.pos() only and
+ *             read nothing that another level 0 process writes;
+ *   level 1 - ctrl_fsm is sensitive to what level 0 writes (DONE,
+ *             MRDY, REPOS, MAGNET, curr_state) and to the inputs
+ *             RESET and uSW_ZERO. What it writes is only read by
+ *             level 0, at the next edge.
+ * So "edge" evaluates level 0 and then level 1 on plain variables,
+ * in a single process activation and without any delta cycle, and
+ * "inputs" re-evaluates level 1 when RESET or uSW_ZERO change.
+ * As in any cycle-based model, the inputs must not change at the
+ * rising clock edge itself.
+ *
+ * Level 1 is ctrl_fsm_step() of robot_model.h on these variables.
+ * curr_state and next_state are written for observation only.
+ * The counter and the instruction bits use the native-width types
+ * of nat_types.h instead of sc_uint and sc_bv.
+ */
+
+SC_MODULE(robot_controller_levelized) {
+
+    sc_in<bool>		CLOCK;
+    sc_in<bool>		RESET;
+    sc_in<sc_bv<8> >	uSEQ_BUS;
+    sc_in<bool>		CLRMRDY;
+    sc_in<bool>		uSW_ZERO;
+
+    sc_inout<bool>	MRDY;
+    sc_inout<bool>	REPOS;
+    sc_inout<bool>	MAGNET;
+    sc_out<bool>	XY;
+    sc_out<bool>	REVERSE;
+    sc_out<bool>	LDDIR;
+    sc_out<bool>	LSB_CNTR;
+
+    typedef robot_controller::ctrl_state ctrl_state;
+    sc_signal<ctrl_state> curr_state, next_state;
+
+    /* member function prototypes */
+    void edge();
+    void inputs();
+
+    /* Constructor */
+    SC_CTOR(robot_controller_levelized) {
+        SC_METHOD(edge);	sensitive << CLOCK.pos();
+        SC_METHOD(inputs);	sensitive << RESET << uSW_ZERO;
+        dont_initialize();
+
+        _curr = _next = robot_controller::IDLE;
+        _counter = 0;
+        _mrdy = _repos = _magnet = _xy = _reverse = _lddir = false;
+        _lddist = _count = _ldinst = _setmrdy = false;
+    }
+
+private:
+    /* level 0 state */
+    ctrl_state		_curr;
+    nat_uint<8>		_counter;
+    bool		_mrdy, _repos, _magnet, _xy, _reverse;
+
+    /* level 1 state */
+    ctrl_state		_next;
+    bool		_lddist, _count, _ldinst, _setmrdy, _lddir;
+
+    void ctrl_fsm();
+};
+#endif
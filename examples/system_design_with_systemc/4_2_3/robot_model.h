@@ -0,0 +1,194 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef ROBOT_MODEL_H
+#define ROBOT_MODEL_H
+
+#include "systemc.h"
+#include "robot.h"
+
+/*
+ * ctrl_fsm_step: the next-state and output function of ctrl_fsm.
+ * "inputs" is a word of robot_controller::IN_* bits, the result is
+ * a word of OUT_* bits and the next state is returned in "next".
+ *
+ * robot_model and robot_controller_levelized call it and the
+ * equations of robot_x64 are built from it. "run.x -t" checks it, like the table
+ * of robot_controller::compile_ctrl_table(), against ctrl_fsm in
+ * robot.cpp for every state and input word.
+ */
+
+inline unsigned
+ctrl_fsm_step(unsigned state, unsigned inputs, unsigned& next)
+{
+    typedef robot_controller rc;
+
+    next = state;
+    if (inputs & rc::IN_RESET) {
+        next = rc::IDLE;
+        return 0;
+    }
+
+    switch (state) {
+    case rc::IDLE:
+        if (! (inputs & rc::IN_MRDY)) {
+            next = rc::INST;
+            return rc::OUT_LDINST;
+        }
+        break;
+    case rc::INST:
+        if (inputs & rc::IN_MAGNET) {
+            next = rc::IDLE;
+            return rc::OUT_SETMRDY;
+        } else if (inputs & rc::IN_REPOS) {
+            next = rc::RECAL;
+            return rc::OUT_LDDIR;
+        }
+        next = rc::DIST;
+        return rc::OUT_SETMRDY;
+    case rc::RECAL:
+        if (inputs & rc::IN_uSW_ZERO) {
+            next = rc::IDLE;
+            return rc::OUT_SETMRDY;
+        }
+        return rc::OUT_COUNT;
+    case rc::DIST:
+        if (! (inputs & rc::IN_MRDY)) {
+            next = rc::DIR;
+            return rc::OUT_LDDIST;
+        }
+        break;
+    case rc::DIR:
+        next = rc::MOVE;
+        return rc::OUT_LDDIR;
+    case rc::MOVE:
+        if (inputs & rc::IN_DONE) {
+            next = rc::IDLE;
+            return rc::OUT_SETMRDY;
+        }
+        return rc::OUT_COUNT;
+    }
+    return 0;
+}
+
+/* Inputs of robot_controller during one clock cycle */
+
+struct robot_inputs {
+    bool		reset;
+    unsigned char	seq;		/* uSEQ_BUS */
+    bool		clrmrdy;
+    bool		sw_zero;	/* uSW_ZERO */
+
+    robot_inputs() : reset(false), seq(0), clrmrdy(false), sw_zero(false) {}
+};
+
+/*
+ * Reference model of robot_controller: plain C++, one call per
+ * clock edge. Its registers start with the values robot_controller
+ * has after the initialization phase (counter 0, so DONE is set).
+ *
+ * comb() is ctrl_fsm, called whenever the inputs change. Like the
+ * original, it only ever sets LDDIR, which therefore stays set.
+ * posedge() is the four clocked processes followed by ctrl_fsm.
+ */
+
+struct robot_model {
+    typedef robot_controller::ctrl_state ctrl_state;
+
+    /* registers */
+    ctrl_state		curr_state;
+    unsigned char	counter;
+    bool		done, lsb_cntr;
+    bool		mrdy, repos, magnet, xy, reverse;
+
+    /* ctrl_fsm outputs */
+    ctrl_state		next_state;
+    bool		lddist, count, ldinst, setmrdy, lddir;
+
+    robot_model() { init(); }
+
+    void init() {
+        curr_state = next_state = robot_controller::IDLE;
+        counter = 0;
+        done = true;
+        lsb_cntr = mrdy = repos = magnet = xy = reverse = false;
+        lddist = count = ldinst = setmrdy = lddir = false;
+    }
+
+    /* the input word of ctrl_fsm_step() */
+    unsigned ctrl_inputs(const robot_inputs& in) const {
+        typedef robot_controller rc;
+        return (in.reset   ? rc::IN_RESET    : 0) |
+               (mrdy       ? rc::IN_MRDY     : 0) |
+               (magnet     ? rc::IN_MAGNET   : 0) |
+               (repos      ? rc::IN_REPOS    : 0) |
+               (in.sw_zero ? rc::IN_uSW_ZERO : 0) |
+               (done       ? rc::IN_DONE     : 0);
+    }
+
+    void comb(const robot_inputs& in) {
+        typedef robot_controller rc;
+        unsigned ns;
+        unsigned out = ctrl_fsm_step(curr_state, ctrl_inputs(in), ns);
+
+        next_state = (ctrl_state) ns;
+        lddist  = (out & rc::OUT_LDDIST) != 0;
+        count   = (out & rc::OUT_COUNT) != 0;
+        ldinst  = (out & rc::OUT_LDINST) != 0;
+        setmrdy = (out & rc::OUT_SETMRDY) != 0;
+        if (out & rc::OUT_LDDIR)
+            lddir = true;
+    }
+
+    /* "in" are the inputs sampled at this edge */
+    void posedge(const robot_inputs& in) {
+        if (lddist) {
+            counter = in.seq;
+        } else if (count) {
+            counter = counter - 1;
+        }
+        done = (counter == 0);
+        lsb_cntr = counter & 1;
+
+        if (ldinst) {
+            repos   = (in.seq >> 0) & 1;
+            magnet  = (in.seq >> 1) & 1;
+            xy      = (in.seq >> 2) & 1;
+            reverse = (in.seq >> 3) & 1;
+        }
+
+        if (in.clrmrdy) {
+            mrdy = false;
+        } else if (setmrdy) {
+            mrdy = true;
+        }
+
+        curr_state = next_state;
+        comb(in);
+    }
+};
+
+#endif
@@ -0,0 +1,480 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef ROBOT_X64_H
+#define ROBOT_X64_H
+
+/*
+ * Bit-parallel robot_controller: 64 independent instances ("lanes")
+ * in the bits of uint64 words, lane i in bit i. Every single-bit
+ * register is one word; the state is one-hot, one word per state;
+ * the 8-bit counter is 8 words, one per bit. A clock edge of all 64
+ * lanes is about a hundred word operations.
+ *
+ * The behaviour of every lane is that of robot_model (see
+ * robot_model.h): comb() when the inputs change, posedge() at the
+ * clock edge. comb() is not written by hand: it evaluates the
+ * sum-of-products form of ctrl_fsm_step() in ROBOT_X64_COVER, which
+ * robot_x64::ctrl_cubes() derives from it and "run.x -t" checks.
+ */
+
+#include <vector>
+#include "robot_model.h"
+
+/* Inputs of 64 lanes; seq[i] holds bit i of uSEQ_BUS */
+
+struct robot_inputs_x64 {
+    uint64	reset;
+    uint64	seq[8];
+    uint64	clrmrdy;
+    uint64	sw_zero;
+
+    robot_inputs_x64() : reset(0), clrmrdy(0), sw_zero(0) {
+        for (unsigned i=0; i < 8; i++)
+            seq[i] = 0;
+    }
+
+    void set(unsigned lane, const robot_inputs& in) {
+        uint64 bit = (uint64) 1 << lane;
+        put(reset, bit, in.reset);
+        put(clrmrdy, bit, in.clrmrdy);
+        put(sw_zero, bit, in.sw_zero);
+        for (unsigned i=0; i < 8; i++)
+            put(seq[i], bit, (in.seq >> i) & 1);
+    }
+
+    void get(unsigned lane, robot_inputs& in) const {
+        in.reset = (reset >> lane) & 1;
+        in.clrmrdy = (clrmrdy >> lane) & 1;
+        in.sw_zero = (sw_zero >> lane) & 1;
+        in.seq = 0;
+        for (unsigned i=0; i < 8; i++)
+            in.seq |= ((seq[i] >> lane) & 1) << i;
+    }
+
+private:
+    static void put(uint64& w, uint64 bit, bool v) {
+        w = v ? (w | bit) : (w & ~bit);
+    }
+};
+
+/*
+ * The cover of ctrl_fsm_step() evaluated by robot_x64::comb(), as
+ * printed by robot_x64::check_cover(). Every CUBE(s, l1, l2, l3,
+ * t1, t2) is the AND of state s (6 is any state) and of literals l1,
+ * l2 and l3, ORed into targets t1 and t2. Literal 2*i is input bit
+ * i (the IN_* bits in order) inverted, 2*i+1 input bit i itself, 12
+ * is true. Target t < 5 is output bit t of ctrl_fsm_step(), target
+ * 5+s the one-hot word of next state s, 11 is none.
+ *
+ * The cover is a list of macro calls rather than built at run time
+ * so that comb() is straight-line code with constant indices.
+ */
+
+#define ROBOT_X64_COVER(CUBE) \
+    CUBE(0, 0, 2, 12, 2, 6) \
+    CUBE(6, 1, 12, 12, 5, 11) \
+    CUBE(0, 3, 12, 12, 5, 11) \
+    CUBE(1, 0, 6, 12, 3, 11) \
+    CUBE(1, 0, 5, 12, 3, 11) \
+    CUBE(1, 0, 4, 7, 4, 8) \
+    CUBE(1, 5, 12, 12, 5, 11) \
+    CUBE(1, 0, 4, 6, 7, 11) \
+    CUBE(2, 0, 2, 12, 0, 9) \
+    CUBE(2, 0, 3, 12, 7, 11) \
+    CUBE(3, 0, 8, 12, 1, 8) \
+    CUBE(3, 0, 9, 12, 3, 11) \
+    CUBE(3, 9, 12, 12, 5, 11) \
+    CUBE(4, 0, 12, 12, 4, 10) \
+    CUBE(5, 0, 10, 12, 1, 10) \
+    CUBE(5, 0, 11, 12, 3, 11) \
+    CUBE(5, 11, 12, 12, 5, 11)
+
+class robot_x64 {
+public:
+    typedef robot_controller::ctrl_state ctrl_state;
+
+    /* bits of the per-lane output word, see outputs() */
+    enum { OUT_MRDY, OUT_REPOS, OUT_MAGNET, OUT_XY, OUT_REVERSE,
+           OUT_LDDIR, OUT_LSB_CNTR, OUT_STATE, OUTPUTS = OUT_STATE + 3 };
+
+    robot_x64() { init(); }
+
+    void init() {
+        for (unsigned s=0; s < STATES; s++)
+            _state[s] = _next[s] = 0;
+        _state[robot_controller::IDLE] = _next[robot_controller::IDLE] = ~(uint64) 0;
+        for (unsigned i=0; i < 8; i++)
+            _counter[i] = 0;
+        _done = ~(uint64) 0;
+        _mrdy = _repos = _magnet = _xy = _reverse = 0;
+        _lddist = _count = _ldinst = _setmrdy = _lddir = 0;
+    }
+
+    void comb(const robot_inputs_x64& in) {
+        /* the inputs of ctrl_fsm_step(), in the order of the IN_* bits */
+        uint64 word[rc::INPUTS] = {
+            in.reset, _mrdy, _magnet, _repos, in.sw_zero, _done
+        };
+        uint64 literal[LITERALS + 1];
+        for (unsigned i=0; i < rc::INPUTS; i++) {
+            literal[2 * i] = ~word[i];
+            literal[2 * i + 1] = word[i];
+        }
+        literal[LIT_TRUE] = ~(uint64) 0;
+
+        uint64 state[STATES + 1];
+        for (unsigned s=0; s < STATES; s++)
+            state[s] = _state[s];
+        state[ANY_STATE] = ~(uint64) 0;
+
+        uint64 f[TARGETS + 1];
+        for (unsigned t=0; t <= TARGETS; t++)
+            f[t] = 0;
+#define ROBOT_X64_CUBE(s, l1, l2, l3, t1, t2) { \
+            uint64 w = state[s] & literal[l1] & literal[l2] & literal[l3]; \
+            f[t1] |= w; \
+            f[t2] |= w; \
+        }
+        ROBOT_X64_COVER(ROBOT_X64_CUBE)
+#undef ROBOT_X64_CUBE
+
+        /* target i < OUTPUTS is bit i of the output word */
+        _lddist  = f[0];
+        _count   = f[1];
+        _ldinst  = f[2];
+        _setmrdy = f[3];
+        _lddir  |= f[4];	/* only ever set */
+        for (unsigned s=0; s < STATES; s++)
+            _next[s] = f[rc::OUTPUTS + s];
+    }
+
+    /* "in" are the inputs sampled at this edge */
+    void posedge(const robot_inputs_x64& in) {
+        /* counter: load, or decrement with a borrow chain */
+        uint64 borrow = _count, any = 0;
+        for (unsigned i=0; i < 8; i++) {
+            uint64 dec = _counter[i] ^ borrow;
+            borrow &= ~_counter[i];
+            _counter[i] = (_lddist & in.seq[i]) | (~_lddist & dec);
+            any |= _counter[i];
+        }
+        _done = ~any;
+
+        _repos   = (_ldinst & in.seq[0]) | (~_ldinst & _repos);
+        _magnet  = (_ldinst & in.seq[1]) | (~_ldinst & _magnet);
+        _xy      = (_ldinst & in.seq[2]) | (~_ldinst & _xy);
+        _reverse = (_ldinst & in.seq[3]) | (~_ldinst & _reverse);
+
+        _mrdy = ~in.clrmrdy & (_mrdy | _setmrdy);
+
+        for (unsigned s=0; s < STATES; s++)
+            _state[s] = _next[s];
+        comb(in);
+    }
+
+    /* output word i holds bit i of outputs() of every lane */
+    void output_words(uint64 out[OUTPUTS]) const {
+        out[OUT_MRDY] = _mrdy;
+        out[OUT_REPOS] = _repos;
+        out[OUT_MAGNET] = _magnet;
+        out[OUT_XY] = _xy;
+        out[OUT_REVERSE] = _reverse;
+        out[OUT_LDDIR] = _lddir;
+        out[OUT_LSB_CNTR] = _counter[0];
+        out[OUT_STATE]     = _state[robot_controller::INST] |
+                             _state[robot_controller::RECAL] |
+                             _state[robot_controller::MOVE];
+        out[OUT_STATE + 1] = _state[robot_controller::DIST] |
+                             _state[robot_controller::RECAL];
+        out[OUT_STATE + 2] = _state[robot_controller::DIR] |
+                             _state[robot_controller::MOVE];
+    }
+
+    /* outputs and state of one lane as a word of OUTPUTS bits */
+    unsigned outputs(unsigned lane) const {
+        uint64 out[OUTPUTS];
+        output_words(out);
+        unsigned w = 0;
+        for (unsigned i=0; i < OUTPUTS; i++)
+            w |= (unsigned) ((out[i] >> lane) & 1) << i;
+        return w;
+    }
+
+    ctrl_state state(unsigned lane) const {
+        return (ctrl_state) (outputs(lane) >> OUT_STATE);
+    }
+
+    /*
+     * Compares ROBOT_X64_COVER with ctrl_fsm_step() for every state,
+     * target and input word and returns the number of differences.
+     * If there are any, the cover derived by ctrl_cubes() is printed
+     * to "os" in the format of ROBOT_X64_COVER, to replace it.
+     */
+    static unsigned check_cover(ostream& os) {
+        unsigned errors = 0;
+        for (unsigned s=0; s < STATES; s++)
+            for (unsigned t=0; t < TARGETS; t++) {
+                uint64 f = truth(s, t);
+                for (unsigned x=0; x < WORDS; x++)
+                    if (cover(s, t, x) != ((f >> x) & 1))
+                        errors++;
+            }
+        if (errors)
+            print_cover(os);
+        return errors;
+    }
+
+    /* the same word, from the reference model */
+    static unsigned outputs(const robot_model& m) {
+        return (m.mrdy << OUT_MRDY) | (m.repos << OUT_REPOS) |
+               (m.magnet << OUT_MAGNET) | (m.xy << OUT_XY) |
+               (m.reverse << OUT_REVERSE) | (m.lddir << OUT_LDDIR) |
+               (m.lsb_cntr << OUT_LSB_CNTR) |
+               ((unsigned) m.curr_state << OUT_STATE);
+    }
+
+private:
+    typedef robot_controller rc;
+    enum { STATES = robot_controller::MOVE + 1 };
+
+    /*
+     * Indices in ROBOT_X64_COVER: state ANY_STATE, literal LIT_TRUE,
+     * target NO_TARGET. A cube has CUBE_LITERALS literals and
+     * CUBE_TARGETS targets.
+     */
+    enum { TARGETS = rc::OUTPUTS + STATES, WORDS = 1 << rc::INPUTS,
+           LITERALS = 2 * rc::INPUTS, ANY_STATE = STATES, LIT_TRUE = LITERALS,
+           NO_TARGET = TARGETS, CUBE_LITERALS = 3, CUBE_TARGETS = 2 };
+
+    /* bit x is set if input word x of state s sets target t */
+    static uint64 truth(unsigned s, unsigned t) {
+        uint64 f = 0;
+        for (unsigned x=0; x < WORDS; x++) {
+            unsigned next, out = ctrl_fsm_step(s, x, next);
+            if (t < rc::OUTPUTS ? ((out >> t) & 1) : next == t - rc::OUTPUTS)
+                f |= (uint64) 1 << x;
+        }
+        return f;
+    }
+
+    /* whether ROBOT_X64_COVER sets target t for input word x of state s */
+    static bool cover(unsigned s, unsigned t, unsigned x) {
+#define ROBOT_X64_ROW(s, l1, l2, l3, t1, t2) { s, l1, l2, l3, t1, t2 },
+        static const unsigned char rows[][6] = {
+            ROBOT_X64_COVER(ROBOT_X64_ROW)
+        };
+#undef ROBOT_X64_ROW
+        for (unsigned k=0; k < sizeof(rows) / sizeof(rows[0]); k++) {
+            const unsigned char* c = rows[k];
+            bool on = c[0] == ANY_STATE || c[0] == s;
+            for (unsigned j=1; j <= CUBE_LITERALS; j++)
+                if (c[j] != LIT_TRUE && ((x >> (c[j] / 2)) & 1) != (c[j] & 1u))
+                    on = false;
+            if (on && (c[4] == t || c[5] == t))
+                return true;
+        }
+        return false;
+    }
+
+    /* the input words that agree with x in the bits of "care" */
+    static uint64 span(unsigned care, unsigned x) {
+        uint64 m = 0;
+        for (unsigned y=0; y < WORDS; y++)
+            if (((y ^ x) & care) == 0)
+                m |= (uint64) 1 << y;
+        return m;
+    }
+
+    /*
+     * A cube of ctrl_cubes(): a state (or ANY_STATE) and the input words
+     * whose bits in "care" are "value", ORed into its targets
+     */
+    struct cube {
+        unsigned	state, care, value;
+        uint64		span;
+        std::vector<unsigned> targets;
+    };
+
+    /*
+     * A cover of every truth table: each input word that is not yet
+     * covered is widened, one input at a time, for as long as the
+     * cube stays inside the truth table. Cubes inside another cube
+     * of the same state and target are dropped, a cube found in
+     * every state is kept once for any state, and cubes with the
+     * same state and inputs are shared by their targets.
+     */
+    static std::vector<cube> ctrl_cubes() {
+        std::vector<cube> cubes, found;
+        unsigned s, t, i, j, k;
+
+        for (s=0; s < STATES; s++)
+            for (t=0; t < TARGETS; t++) {
+                uint64 f = truth(s, t), covered = 0;
+                found.clear();
+                for (unsigned x=0; x < WORDS; x++) {
+                    if (((f & ~covered) >> x & 1) == 0)
+                        continue;
+                    unsigned care = WORDS - 1;
+                    for (i=0; i < rc::INPUTS; i++) {
+                        unsigned wider = care & ~(1u << i);
+                        if ((span(wider, x) & ~f) == 0)
+                            care = wider;
+                    }
+                    cube c;
+                    c.state = s;
+                    c.care = care;
+                    c.value = x & care;
+                    c.span = span(care, x);
+                    c.targets.push_back(t);
+                    found.push_back(c);
+                    covered |= c.span;
+                }
+                /* of two equal cubes the first is kept */
+                for (k=0; k < found.size(); k++) {
+                    for (j=0; j < found.size(); j++)
+                        if (j != k && (found[k].span & ~found[j].span) == 0 &&
+                            (found[k].span != found[j].span || j < k))
+                            break;
+                    if (j == found.size())
+                        add_cube(cubes, found[k]);
+                }
+            }
+
+        /* a cube of one target in every state */
+        for (k=0; k < cubes.size(); k++) {
+            if (cubes[k].state != 0 || cubes[k].targets.size() != 1)
+                continue;
+            std::vector<unsigned> same(1, k);
+            for (j=k+1; j < cubes.size(); j++)
+                if (cubes[j].care == cubes[k].care &&
+                    cubes[j].value == cubes[k].value &&
+                    cubes[j].targets == cubes[k].targets)
+                    same.push_back(j);
+            if (same.size() != STATES)
+                continue;
+            cubes[k].state = ANY_STATE;
+            for (j=same.size() - 1; j > 0; j--)
+                cubes.erase(cubes.begin() + same[j]);
+        }
+        return cubes;
+    }
+
+    /* adds "c", or its target to a cube with the same inputs */
+    static void add_cube(std::vector<cube>& cubes, const cube& c) {
+        for (unsigned j=0; j < cubes.size(); j++)
+            if (cubes[j].state == c.state && cubes[j].care == c.care &&
+                cubes[j].value == c.value) {
+                cubes[j].targets.push_back(c.targets[0]);
+                return;
+            }
+        cubes.push_back(c);
+    }
+
+    /* prints ctrl_cubes() as the body of ROBOT_X64_COVER */
+    static void print_cover(ostream& os) {
+        std::vector<cube> cubes = ctrl_cubes();
+        for (unsigned k=0; k < cubes.size(); k++) {
+            const cube& c = cubes[k];
+            unsigned row[6], n = 1, literals = 0;
+            row[0] = c.state;
+            for (unsigned i=0; i < rc::INPUTS; i++)
+                if ((c.care >> i) & 1 && ++literals <= CUBE_LITERALS)
+                    row[n++] = 2 * i + ((c.value >> i) & 1);
+            while (n <= CUBE_LITERALS)
+                row[n++] = LIT_TRUE;
+            for (unsigned j=0; j < CUBE_TARGETS; j++)
+                row[n++] = j < c.targets.size() ? c.targets[j]
+                                                : (unsigned) NO_TARGET;
+
+            os << "    CUBE(";
+            for (unsigned j=0; j < 6; j++)
+                os << (j ? ", " : "") << row[j];
+            os << ")";
+            if (literals > CUBE_LITERALS || c.targets.size() > CUBE_TARGETS)
+                os << "\t/* does not fit */";
+            os << (k + 1 < cubes.size() ? " \\" : "") << endl;
+        }
+    }
+
+    /* registers */
+    uint64	_state[STATES];
+    uint64	_counter[8];
+    uint64	_done;
+    uint64	_mrdy, _repos, _magnet, _xy, _reverse;
+
+    /* ctrl_fsm outputs */
+    uint64	_next[STATES];
+    uint64	_lddist, _count, _ldinst, _setmrdy, _lddir;
+};
+
+/*
+ * Per-lane trace signature: a 32-bit multiple-input signature
+ * register (CRC-32 polynomial) per lane, fed with the output word
+ * of the lane every cycle. trace_x64 keeps the signatures of all
+ * 64 lanes bit-sliced; trace_sig does the same for one lane.
+ */
+
+inline unsigned
+trace_sig(unsigned sig, unsigned outputs)
+{
+    return ((sig << 1) ^ ((sig >> 31) ? 0x04c11db7u : 0)) ^ outputs;
+}
+
+class trace_x64 {
+public:
+    trace_x64() {
+        for (unsigned i=0; i < 32; i++)
+            _sig[i] = 0;
+    }
+
+    void add(const robot_x64& r) {
+        uint64 out[robot_x64::OUTPUTS];
+        r.output_words(out);
+
+        uint64 msb = _sig[31];
+        for (unsigned i=31; i > 0; i--)
+            _sig[i] = _sig[i-1];
+        _sig[0] = 0;
+        for (unsigned i=0; i < 32; i++)
+            if ((0x04c11db7u >> i) & 1)
+                _sig[i] ^= msb;
+        for (unsigned i=0; i < robot_x64::OUTPUTS; i++)
+            _sig[i] ^= out[i];
+    }
+
+    unsigned signature(unsigned lane) const {
+        unsigned s = 0;
+        for (unsigned i=0; i < 32; i++)
+            s |= (unsigned) ((_sig[i] >> lane) & 1) << i;
+        return s;
+    }
+
+private:
+    uint64 _sig[32];
+};
+
+#endif
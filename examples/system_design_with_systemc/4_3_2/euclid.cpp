@@ -27,34 +27,53 @@
 #include "systemc.h"
 #include "euclid.h"
 
+// untimed request: only allowed while the module is in untimed mode
+
+unsigned
+euclid_gcd::call(unsigned a, unsigned b, unsigned& cycles)
+{
+    assert(!_timed);
+    unsigned steps;
+    _result = gcd(a, b, steps);
+    cycles = HANDSHAKE_CYCLES + steps * _cycles_per_step;
+    _requests++;
+    _cycles += cycles;
+    return _result;
+}
+
 void
 euclid_gcd::compute()
 {
     // reset section
-    unsigned tmp_a = 0, tmp_b;
+    if (RESET.read() == true)
+        _result = 0;
+    unsigned tmp_a, tmp_b, steps;
 
     while (true) {	// main loop
 
         // Here is an I/O cycle
-        C.write(tmp_a);		// place output on C
+        C.write(_result);	// place output on C
         READY.write(true);	// and assert READY
         wait();
 
+        // In untimed mode requests are made by call(), so only
+        // the latest result is shown
+        if (!_timed)
+            continue;
+
         // Another I/O cycle starts here
         tmp_a = A.read();	// sample inputs
         tmp_b = B.read();
         READY.write(false);	// lower READY
-        wait();
 
         // No I/O takes place during the computation of GCD.
-        // Computation and communication are separated
-        while (tmp_b != 0) {	// Euclid's algorithm
-            unsigned r = tmp_a;
-            tmp_a = tmp_b;
-            while (r >= tmp_b) {
-                r = r - tmp_b;
-            }
-            tmp_b = r;
-        }
+        // Computation and communication are separated. The
+        // result is kept at once, so that call() supersedes it.
+        _result = gcd(tmp_a, tmp_b, steps);
+        _requests++;
+        _cycles += HANDSHAKE_CYCLES + steps * _cycles_per_step;
+        wait();
+        if (steps * _cycles_per_step > 0)
+            wait(steps * _cycles_per_step);
     }
 }
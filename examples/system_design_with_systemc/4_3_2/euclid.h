@@ -27,6 +27,25 @@
 #ifndef EUCLID_H
 #define EUCLID_H
 
+// euclid_gcd: computes the GCD of A and B with a READY handshake.
+//   In timed mode (the default) the handshake is cycle accurate:
+//   READY is high for one cycle, A and B are sampled in the next
+//   one and the result is on C in the cycle after that, so every
+//   request takes HANDSHAKE_CYCLES. The datapath takes no cycles
+//   of its own unless "cycles_per_step" is given, in which case
+//   every step counted by gcd() adds that many cycles.
+//
+//   In untimed mode the ports are not sampled; requests are made
+//   by calling call() instead, which computes the GCD at once and
+//   returns the cycles the request takes in timed mode. The mode
+//   can be switched at any time, also during the simulation, to
+//   fast-forward to a point of interest: a timed request in
+//   flight is superseded by the calls, and the last result of
+//   call() is the next value shown on C. Simulated time does not
+//   advance over the calls; their cycles are added to cycles().
+//
+//   gcd() is the datapath; it is also used by gcd_farm (4_3_2b).
+
 SC_MODULE(euclid_gcd) {
     sc_in_clk		CLOCK;
     sc_in<bool>		RESET;
@@ -34,11 +53,55 @@ SC_MODULE(euclid_gcd) {
     sc_out<unsigned>	C;
     sc_out<bool>	READY;
 
+    enum { HANDSHAKE_CYCLES = 2 };
+
     void compute();
-    SC_CTOR(euclid_gcd) {
+
+    SC_HAS_PROCESS(euclid_gcd);
+    euclid_gcd(sc_module_name name, unsigned cycles_per_step = 0)
+      : sc_module(name), _cycles_per_step(cycles_per_step)
+    {
         SC_CTHREAD(compute, CLOCK.pos());
         watching(RESET.delayed() == true);
+        _timed = true;
+        _result = 0;
+        _requests = 0;
+        _cycles = 0;
     }
+
+    // Euclid's algorithm with modulo by repeated subtraction;
+    // "steps" is set to one per subtraction plus one per exchange
+    // of the operands
+    static unsigned gcd(unsigned a, unsigned b, unsigned& steps)
+    {
+        steps = 0;
+        while (b != 0) {
+            unsigned r = a;
+            a = b;
+            steps++;
+            while (r >= b) {
+                r = r - b;
+                steps++;
+            }
+            b = r;
+        }
+        return a;
+    }
+
+    unsigned call(unsigned a, unsigned b, unsigned& cycles);
+
+    void set_timed(bool timed) { _timed = timed; }
+    bool timed() const { return _timed; }
+
+    // requests served and their cycles, in both modes
+    unsigned requests() const { return _requests; }
+    unsigned cycles() const { return _cycles; }
+
+private:
+    unsigned _cycles_per_step;
+    bool _timed;
+    unsigned _result;	// last GCD computed
+    unsigned _requests, _cycles;
 };
 
 #endif
@@ -24,33 +24,83 @@
 //****************************************************************************
 
 
+#include <time.h>
 #include "systemc.h"
 #include "euclid.h"
 
 
+// untimed requests with pseudo-random operands; returns the cycles
+// they take
+
+static unsigned
+fast_forward(euclid_gcd& div, unsigned requests)
+{
+  unsigned seed = 1, cycles, total = 0, result = 0;
+  clock_t t = clock();
+
+  div.set_timed(false);
+  for (unsigned i=0; i < requests; i++) {
+    seed = seed * 1103515245 + 12345;
+    unsigned a = (seed >> 8) % 1000 + 1;
+    seed = seed * 1103515245 + 12345;
+    unsigned b = (seed >> 8) % 1000 + 1;
+    result = div.call(a, b, cycles);
+    total += cycles;
+  }
+  div.set_timed(true);
+
+  cout << "fast-forward at " << sc_time_stamp() << ": " << requests
+       << " requests, " << total << " cycles in "
+       << (double) (clock() - t) / CLOCKS_PER_SEC << " s, last result "
+       << result << endl;
+  return total;
+}
+
+// top: the clock is created by start_at(), after requests may have
+//   been made in untimed mode. The clock and the stimulus start at
+//   the time given there, so that the cycles of those requests are
+//   accounted for in simulated time. fast_forward_at() instead
+//   switches to untimed mode during the simulation.
+
 class top : public sc_module
 {
 public:
   SC_HAS_PROCESS(top);
 
-  top(sc_module_name name) : div("d1"), clk("c1", 1, SC_NS)
+  top(sc_module_name name) : div("d1"), clk(0), _ff_requests(0)
   {
     SC_THREAD(t1);
     SC_THREAD(t2);
     SC_METHOD(t3);
     sensitive << c;
+    SC_THREAD(ff);
 
     div.A(a);
     div.B(b);
     div.C(c);
-    div.CLOCK(clk);
     div.RESET(reset);
     div.READY(ready);
   }
 
+  ~top() { delete clk; }
+
+  // to be called once, before sc_start()
+  void start_at(const sc_time& start) {
+    _start = start;
+    clk = new sc_clock("c1", sc_time(1, SC_NS), 0.5, start);
+    div.CLOCK(*clk);
+  }
+
+  // makes "requests" untimed requests at time "at" after the start
+  void fast_forward_at(const sc_time& at, unsigned requests) {
+    _ff_at = at;
+    _ff_requests = requests;
+  }
+
   void t1() {
     reset.write(false);
 
+    wait(_start);
     wait(10, SC_NS);
     a = 40;
 
@@ -59,6 +109,7 @@ public:
   }
 
   void t2() {
+    wait(_start);
     wait(10, SC_NS);
     b = 10;
 
@@ -70,17 +121,49 @@ public:
     cout << "at time: " << sc_time_stamp() << " output: " << c.read() << endl;
   }
 
+  void ff() {
+    if (_ff_requests == 0)
+      return;
+    wait(_start + _ff_at);
+    fast_forward(div, _ff_requests);
+  }
+
   euclid_gcd div;
   sc_signal<unsigned> a, b, c;
   sc_signal<bool> reset, ready;
-  sc_clock clk;
+  sc_clock* clk;
+
+private:
+  sc_time _start, _ff_at;
+  unsigned _ff_requests;
 };
 
+// usage: run.x [requests [at]]
+//   "requests" pseudo-random requests are made in untimed mode.
+//   Without "at" they are made before the simulation starts, and
+//   the timed simulation continues from the last result at the
+//   simulated time these requests would have taken (1 ns per
+//   cycle). With "at" the mode is switched "at" ns into the
+//   simulation and back after the requests; simulated time does
+//   not advance over them.
+
 int sc_main (int argc , char *argv[]) 
 {
+  unsigned requests = 0;
+  if (argc > 1) requests = atoi(argv[1]);
+
   top top1("Top1");
-  sc_start(100, SC_NS);
+
+  unsigned cycles = 0;
+  if (argc > 2)
+    top1.fast_forward_at(sc_time(atoi(argv[2]), SC_NS), requests);
+  else if (requests > 0)
+    cycles = fast_forward(top1.div, requests);
+
+  sc_time start(cycles, SC_NS);
+  top1.start_at(start);
+
+  sc_start(start + sc_time(100, SC_NS));
   cout << endl << endl;
   return 0;
 }
-
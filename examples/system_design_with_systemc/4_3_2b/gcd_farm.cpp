@@ -0,0 +1,232 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+#include <iomanip>
+#include "systemc.h"
+#include "gcd_farm.h"
+
+gcd_farm::gcd_farm(sc_module_name name, unsigned lanes,
+                   gcd_algorithm alg, unsigned rob_size)
+  : sc_module(name), _alg(alg), _next_seq(0), _next_retire(0),
+    _cycle(0), _completed(0), _max_latency(0), _sum_latency(0)
+{
+    assert(lanes > 0);
+    if (rob_size == 0)
+        rob_size = 2 * lanes;
+
+    SC_METHOD(tick);
+    sensitive << CLOCK.neg();
+    dont_initialize();
+
+    SC_CTHREAD(retire, CLOCK.pos());
+
+    char buf[16];
+    for (unsigned k=0; k < lanes; k++) {
+        sprintf(buf, "lane%d", k);
+        gcd_lane* lane = new gcd_lane(buf, this, k, alg);
+        lane->CLOCK(CLOCK);
+        _lanes.push_back(lane);
+    }
+
+    lane_slot idle;
+    idle.full = false;
+    idle.free_at = 0;
+    idle.seq = 0;
+    _slots.resize(lanes, idle);
+
+    rob_entry empty;
+    empty.valid = false;
+    empty.start = empty.done = 0;
+    _rob.resize(rob_size, empty);
+
+    _busy.resize(lanes, 0);
+    _served.resize(lanes, 0);
+    for (unsigned i=0; i < LATENCY_BUCKETS; i++)
+        _latency[i] = 0;
+}
+
+gcd_farm::~gcd_farm()
+{
+    for (unsigned k=0; k < _lanes.size(); k++)
+        delete _lanes[k];
+}
+
+// The cycle counter advances and requests are assigned on the
+// falling edge, so every process triggered by the rising edge sees
+// the same values, whatever order they run in. A lane that
+// completes at a rising edge takes its next request at that edge,
+// and reports how long it is busy with it (busy_for()) before the
+// next falling edge.
+
+void
+gcd_farm::tick()
+{
+    _cycle++;
+
+    for (unsigned k=0; k < _slots.size(); k++) {
+        lane_slot& s = _slots[k];
+        if (s.full || s.free_at > _cycle)
+            continue;			// busy at the next rising edge
+        if (_next_seq == _next_retire + _rob.size())
+            break;			// reorder buffer full
+        if (!REQ->nb_read(s.req))
+            break;
+
+        s.seq = _next_seq++;
+        s.full = true;
+    }
+}
+
+bool
+gcd_farm::take(unsigned lane, gcd_request& req, unsigned& seq)
+{
+    lane_slot& s = _slots[lane];
+    if (!s.full)
+        return false;
+    s.full = false;
+    req = s.req;
+    seq = s.seq;
+    return true;
+}
+
+// lane "lane" has taken its request in this cycle and is busy
+// for "cycles" cycles
+void
+gcd_farm::busy_for(unsigned lane, unsigned cycles)
+{
+    _slots[lane].free_at = _cycle + cycles;
+}
+
+void
+gcd_farm::complete(unsigned seq, unsigned lane, unsigned start,
+                   unsigned cycles, const gcd_request& req, unsigned gcd)
+{
+    rob_entry& e = _rob[seq % _rob.size()];
+    e.valid = true;
+    e.start = start;
+    e.done = _cycle;
+    e.resp.id = req.id;
+    e.resp.a = req.a;
+    e.resp.b = req.b;
+    e.resp.gcd = gcd;
+    e.resp.cycles = cycles;
+    e.resp.lane = lane;
+
+    _busy[lane] += cycles;
+    _served[lane]++;
+}
+
+void
+gcd_farm::retire()
+{
+    while (true) {
+        // results are written one cycle after their lane completes
+        rob_entry& e = _rob[_next_retire % _rob.size()];
+        if (e.valid && e.done < _cycle && RESP->nb_write(e.resp)) {
+            e.valid = false;
+            _next_retire++;
+            _completed++;
+
+            unsigned latency = _cycle - e.start;
+            unsigned bucket = 0;
+            while ((2u << bucket) <= latency && bucket < LATENCY_BUCKETS-1)
+                bucket++;
+            _latency[bucket]++;
+            _sum_latency += latency;
+            if (latency > _max_latency)
+                _max_latency = latency;
+        }
+        wait();
+    }
+}
+
+void
+gcd_farm::report(ostream& os) const
+{
+    os << name() << ": " << _lanes.size() << " lanes, "
+       << (_alg == GCD_STEIN ? "binary (Stein)" : "Euclid") << " GCD, "
+       << _rob.size() << " reorder buffer entries" << endl;
+    os << "  " << _completed << " requests in " << _cycle << " cycles";
+    if (_cycle > 0)
+        os << ", throughput " << (double) _completed / _cycle
+           << " requests/cycle";
+    os << endl;
+
+    for (unsigned k=0; k < _lanes.size(); k++) {
+        os << "  lane " << k << ": " << _served[k] << " requests, busy "
+           << _busy[k] << " cycles";
+        if (_cycle > 0)
+            os << " (" << 100.0 * _busy[k] / _cycle << "%)";
+        os << endl;
+    }
+
+    if (_completed == 0)
+        return;
+
+    os << "  latency: mean " << _sum_latency / _completed
+       << " cycles, max " << _max_latency << " cycles" << endl;
+    for (unsigned i=0; i < LATENCY_BUCKETS; i++) {
+        if (_latency[i] == 0)
+            continue;
+        unsigned lo = (i == 0) ? 0 : (1u << i);
+        os << "    " << setw(10) << lo << " .. " << setw(10)
+           << ((2u << i) - 1) << ": " << setw(8) << _latency[i] << " ";
+        unsigned bar = (unsigned) (50.0 * _latency[i] / _completed + 0.5);
+        for (unsigned j=0; j < bar; j++)
+            os << '#';
+        os << endl;
+    }
+}
+
+unsigned
+gcd_lane::compute(unsigned a, unsigned b, unsigned& cycles) const
+{
+    if (_alg == GCD_STEIN)
+        return gcd_stein(a, b, cycles);
+    return euclid_gcd::gcd(a, b, cycles);
+}
+
+void
+gcd_lane::run()
+{
+    gcd_request req;
+    unsigned seq, gcd, cycles;
+
+    while (true) {
+        // take the assigned request; an idle lane checks once
+        // per cycle
+        while (!_farm->take(_index, req, seq))
+            wait();
+
+        unsigned start = _farm->_cycle;
+        gcd = compute(req.a, req.b, cycles);
+
+        // one cycle to load the operands, then the datapath cycles
+        _farm->busy_for(_index, 1 + cycles);
+        wait(1 + cycles);
+
+        _farm->complete(seq, _index, start, 1 + cycles, req, gcd);
+    }
+}
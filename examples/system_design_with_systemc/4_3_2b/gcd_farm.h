@@ -0,0 +1,216 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef GCD_FARM_H
+#define GCD_FARM_H
+
+#include <vector>
+#include "../4_3_2/euclid.h"
+
+// GCD algorithms with cycle annotation. Both return the GCD of
+// "a" and "b" and set "cycles" to the number of clock cycles the
+// datapath needs, one per loop iteration:
+//   euclid_gcd::gcd (4_3_2) - Euclid's algorithm with modulo by
+//     repeated subtraction, the datapath of euclid_gcd: one cycle
+//     per subtraction plus one per exchange of the operands
+//   gcd_stein - binary GCD: one cycle per shift and one per
+//     subtraction
+
+inline unsigned gcd_stein(unsigned a, unsigned b, unsigned& cycles)
+{
+    cycles = 0;
+    if (a == 0) return b;
+    if (b == 0) return a;
+
+    unsigned shift = 0;
+    while (((a | b) & 1) == 0) {	// common factors of two
+        a >>= 1;
+        b >>= 1;
+        shift++;
+        cycles++;
+    }
+    while ((a & 1) == 0) {
+        a >>= 1;
+        cycles++;
+    }
+    do {				// "a" is odd from here on
+        while ((b & 1) == 0) {
+            b >>= 1;
+            cycles++;
+        }
+        if (a > b) {
+            unsigned t = a;
+            a = b;
+            b = t;
+        }
+        b = b - a;
+        cycles++;
+    } while (b != 0);
+    return a << shift;
+}
+
+enum gcd_algorithm { GCD_EUCLID, GCD_STEIN };
+
+struct gcd_request {
+    unsigned id;
+    unsigned a, b;
+
+    gcd_request() : id(0), a(0), b(0) {}
+};
+
+struct gcd_response {
+    unsigned id;
+    unsigned a, b;
+    unsigned gcd;
+    unsigned cycles;	// cycles spent in the lane
+    unsigned lane;
+
+    gcd_response() : id(0), a(0), b(0), gcd(0), cycles(0), lane(0) {}
+};
+
+inline ostream& operator<<(ostream& os, const gcd_request& r)
+{
+    return os << r.id << ": gcd(" << r.a << ", " << r.b << ")";
+}
+
+inline ostream& operator<<(ostream& os, const gcd_response& r)
+{
+    return os << r.id << ": gcd(" << r.a << ", " << r.b << ") = " << r.gcd
+              << " in " << r.cycles << " cycles on lane " << r.lane;
+}
+
+class gcd_farm;
+
+// gcd_lane: one GCD datapath of a gcd_farm. It takes the request
+//   the farm has assigned to it, computes the GCD with its
+//   algorithm, tells the farm how many cycles that takes (one to
+//   load the operands, plus the datapath cycles), and after these
+//   cycles hands the result back to the farm.
+
+class gcd_lane : public sc_module {
+public:
+    sc_in_clk CLOCK;
+
+    SC_HAS_PROCESS(gcd_lane);
+
+    gcd_lane(sc_module_name name, gcd_farm* farm, unsigned index,
+             gcd_algorithm alg)
+      : sc_module(name), _farm(farm), _index(index), _alg(alg)
+    {
+        SC_CTHREAD(run, CLOCK.pos());
+    }
+
+private:
+    gcd_farm* _farm;
+    unsigned _index;
+    gcd_algorithm _alg;
+
+    unsigned compute(unsigned a, unsigned b, unsigned& cycles) const;
+    void run();
+};
+
+// gcd_farm: K GCD lanes behind one request FIFO.
+//   At every falling clock edge the farm reads requests from REQ
+//   for the lanes that are idle at the next rising edge, one per
+//   lane, in lane order. As one process makes all assignments,
+//   which lane serves which request does not depend on the order
+//   the kernel runs the lanes in. Requests get a sequence number
+//   when they are assigned; results are held in a reorder buffer
+//   and written to RESP in request order, at most one per clock
+//   cycle, starting the cycle after their lane completes. No
+//   request is assigned while the reorder buffer has no room for
+//   it. Every response carries the id of its request.
+//
+//   The farm counts busy and idle cycles of every lane, and the
+//   latency (in cycles, from taking a request until its result is
+//   written to RESP) in a histogram with power-of-two buckets.
+//
+// Constructor parameters:
+//   sc_module_name name - specifies instance name
+//   unsigned lanes - number of lanes
+//   gcd_algorithm alg - GCD algorithm of the lanes
+//   unsigned rob_size - reorder buffer entries, 0 for 2 * lanes
+
+class gcd_farm : public sc_module {
+public:
+    sc_in_clk CLOCK;
+    sc_fifo_in<gcd_request> REQ;
+    sc_fifo_out<gcd_response> RESP;
+
+    SC_HAS_PROCESS(gcd_farm);
+
+    gcd_farm(sc_module_name name, unsigned lanes,
+             gcd_algorithm alg = GCD_EUCLID, unsigned rob_size = 0);
+    ~gcd_farm();
+
+    unsigned cycles() const { return _cycle; }
+    unsigned completed() const { return _completed; }
+
+    void report(ostream& os) const;
+
+private:
+    friend class gcd_lane;
+
+    enum { LATENCY_BUCKETS = 32 };
+
+    struct rob_entry {
+        bool valid;
+        unsigned start;		// cycle the request was taken
+        unsigned done;		// cycle its lane completed it
+        gcd_response resp;
+    };
+
+    // a request assigned to a lane
+    struct lane_slot {
+        bool full;		// assigned, not yet taken by the lane
+        unsigned free_at;	// first cycle the lane takes a request
+        unsigned seq;
+        gcd_request req;
+    };
+
+    gcd_algorithm _alg;
+    std::vector<gcd_lane*> _lanes;
+    std::vector<lane_slot> _slots;
+    std::vector<rob_entry> _rob;
+    unsigned _next_seq, _next_retire;
+
+    unsigned _cycle, _completed;
+    std::vector<unsigned> _busy, _served;	// per lane
+    unsigned _latency[LATENCY_BUCKETS];
+    unsigned _max_latency;
+    double _sum_latency;
+
+    // called by the lanes
+    bool take(unsigned lane, gcd_request& req, unsigned& seq);
+    void busy_for(unsigned lane, unsigned cycles);
+    void complete(unsigned seq, unsigned lane, unsigned start,
+                  unsigned cycles, const gcd_request& req, unsigned gcd);
+
+    void tick();
+    void retire();
+};
+
+#endif
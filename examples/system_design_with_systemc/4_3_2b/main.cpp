@@ -0,0 +1,137 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+#include "systemc.h"
+#include "gcd_farm.h"
+
+// source: writes "count" requests with pseudo-random operands
+//   (a fixed linear congruential generator, so every run sees
+//   the same requests) to the request FIFO
+
+class source : public sc_module
+{
+public:
+  sc_fifo_out<gcd_request> out;
+
+  SC_HAS_PROCESS(source);
+
+  source(sc_module_name name, unsigned count, unsigned max_operand)
+    : sc_module(name), _count(count), _max(max_operand), _seed(12345)
+  {
+    SC_THREAD(main);
+  }
+
+  void main() {
+    gcd_request req;
+    for (unsigned i=0; i < _count; i++) {
+      req.id = i;
+      req.a = random() % _max + 1;
+      req.b = random() % _max + 1;
+      out.write(req);
+    }
+  }
+
+private:
+  unsigned _count, _max, _seed;
+
+  unsigned random() {
+    _seed = _seed * 1103515245 + 12345;
+    return (_seed >> 8) & 0xffffff;
+  }
+};
+
+// sink: checks that the results arrive in request order and
+//   are correct, and stops the simulation after "count" results
+
+class sink : public sc_module
+{
+public:
+  sc_fifo_in<gcd_response> in;
+
+  SC_HAS_PROCESS(sink);
+
+  sink(sc_module_name name, unsigned count)
+    : sc_module(name), _count(count), _errors(0)
+  {
+    SC_THREAD(main);
+  }
+
+  unsigned errors() const { return _errors; }
+
+  void main() {
+    gcd_response resp;
+    unsigned cycles;
+    for (unsigned i=0; i < _count; i++) {
+      in.read(resp);
+      if (resp.id != i || resp.gcd != euclid_gcd::gcd(resp.a, resp.b, cycles)) {
+        if (_errors++ < 10)
+          cout << "error: expected result " << i << ", got " << resp << endl;
+      }
+      else if (i < 5)
+        cout << "at time: " << sc_time_stamp() << " " << resp << endl;
+    }
+    sc_stop();
+  }
+
+private:
+  unsigned _count, _errors;
+};
+
+// usage: run.x [lanes [requests [max_operand [stein]]]]
+
+int sc_main (int argc , char *argv[])
+{
+  unsigned lanes = 4, count = 10000, max_operand = 1000;
+  gcd_algorithm alg = GCD_EUCLID;
+
+  if (argc > 1) lanes = atoi(argv[1]);
+  if (argc > 2) count = atoi(argv[2]);
+  if (argc > 3) max_operand = atoi(argv[3]);
+  if (argc > 4 && strcmp(argv[4], "stein") == 0) alg = GCD_STEIN;
+  if (lanes < 1) lanes = 1;
+  if (max_operand < 1) max_operand = 1;
+
+  sc_clock clk("c1", 1, SC_NS);
+  sc_fifo<gcd_request> requests(16);
+  sc_fifo<gcd_response> responses(16);
+
+  source src("src", count, max_operand);
+  src.out(requests);
+
+  gcd_farm farm("farm", lanes, alg);
+  farm.CLOCK(clk);
+  farm.REQ(requests);
+  farm.RESP(responses);
+
+  sink snk("snk", count);
+  snk.in(responses);
+
+  sc_start(-1);
+
+  cout << endl;
+  farm.report(cout);
+  cout << snk.errors() << " errors" << endl << endl;
+  return snk.errors() ? 1 : 0;
+}
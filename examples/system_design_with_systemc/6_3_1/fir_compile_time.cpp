@@ -28,63 +28,7 @@
 
 #define SC_INCLUDE_FX
 #include <systemc.h>
-
-// class template "fir"
-//
-// Template Parameters:
-//   class T - specifies the data-type used within the FIR
-//     T must be a numeric type that supports:
-//      operator==(const T&)
-//      operator=(int)
-//      operator+=(const T&)
-//      operator*(const T&)
-//   unsigned N - specifies the number of taps in FIR
-//     N must be greater than zero
-//
-// Constructor parameters:
-//   sc_module_name name - specifies instance name
-//   const T* coeffs - pointer to coefficient array
-//     coeffs array must contain N coefficients
-
-template <class T, unsigned N> class fir: public sc_module {
-public:
-    sc_in<bool> clock;
-    sc_in<T> in;
-    sc_out<T> out;
-
-    SC_HAS_PROCESS(fir);
-
-    fir(sc_module_name name, const T* coeffs) :
-        sc_module(name), _coeffs(coeffs) 
-    {
-        assert(N > 0);
-        SC_METHOD(main);
-        sensitive << clock.pos();
-
-        for (unsigned i=0; i < N; i++)
-            _delay_line[i] = 0;
-    }
-
-private:
-    T _delay_line[N];
-    const T* _coeffs;
-
-    void main() {
-        // shift samples within delay line
-        for (unsigned j=N-1; j > 0; j--)
-            _delay_line[j] = _delay_line[j-1];
-
-        // read new data sample
-        _delay_line[0] = in.read();
-
-        // compute fir output
-        T sum = 0;
-        for (unsigned i=0; i < N; i++)
-            sum += _delay_line[i] * _coeffs[i];
-
-        out.write(sum);
-    } 
-};
+#include "fir_compile_time.h"
 
 // simple stimulus generator
 
@@ -126,6 +70,35 @@ public:
     }
 };
 
+// compare: reports and counts every clock cycle in which two
+//   outputs differ
+
+template <class T> class compare : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in1, in2;
+
+    SC_HAS_PROCESS(compare);
+
+    compare(sc_module_name name) : sc_module(name), _errors(0) {
+        SC_METHOD(main);
+        sensitive << clock.neg();
+    }
+
+    unsigned errors() const { return _errors; }
+
+private:
+    unsigned _errors;
+
+    void main() {
+        if (!(in1.read() == in2.read())) {
+            cout << "at time: " << sc_time_stamp() << " mismatch: "
+                 << in1.read() << " != " << in2.read() << endl;
+            _errors++;
+        }
+    }
+};
+
 int sc_main (int argc , char *argv[]) 
 {
     // to use a fixed-point type, uncomment next line
@@ -139,12 +112,24 @@ int sc_main (int argc , char *argv[])
     sc_clock clock("c1", 1, SC_NS);
     sc_signal<fir_T> fir_in;
     sc_signal<fir_T> fir_out;
+    sc_signal<fir_T> ref_out;
 
-    fir<fir_T, taps> fir1("fir1", &coeffs[0]);
+    fir<fir_T, taps> fir1("fir1", &coeffs[0], true);
     fir1.clock(clock);
     fir1.in(fir_in);
     fir1.out(fir_out);
 
+    // the same filter without activity_aware, as a reference
+    fir<fir_T, taps> ref1("ref1", &coeffs[0]);
+    ref1.clock(clock);
+    ref1.in(fir_in);
+    ref1.out(ref_out);
+
+    compare<fir_T> cmp1("cmp1");
+    cmp1.clock(clock);
+    cmp1.in1(fir_out);
+    cmp1.in2(ref_out);
+
     stimulus<fir_T> stim1("stim1");
     stim1.out(fir_in);
 
@@ -152,5 +137,7 @@ int sc_main (int argc , char *argv[])
     resp1.in(fir_out);
 
     sc_start(100, SC_NS);
-    return 0;
+
+    cout << "activity_aware: " << cmp1.errors() << " mismatches" << endl;
+    return cmp1.errors() ? 1 : 0;
 }
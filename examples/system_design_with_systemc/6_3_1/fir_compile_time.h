@@ -0,0 +1,123 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef FIR_COMPILE_TIME_H
+#define FIR_COMPILE_TIME_H
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+
+// class template "fir"
+//
+// Template Parameters:
+//   class T - specifies the data-type used within the FIR
+//     T must be a numeric type that supports:
+//      operator==(const T&)
+//      operator=(int)
+//      operator+=(const T&)
+//      operator*(const T&)
+//   unsigned N - specifies the number of taps in FIR
+//     N must be greater than zero
+//
+// Constructor parameters:
+//   sc_module_name name - specifies instance name
+//   const T* coeffs - pointer to coefficient array
+//     coeffs array must contain N coefficients
+//   bool activity_aware - if true, the FIR stops evaluating once
+//     the input has been constant for N clock cycles (the output
+//     has then settled) and resumes at the first clock edge after
+//     the input changes. The output is the same as without it.
+
+template <class T, unsigned N> class fir: public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in;
+    sc_out<T> out;
+
+    SC_HAS_PROCESS(fir);
+
+    fir(sc_module_name name, const T* coeffs, bool activity_aware = false) :
+        sc_module(name), _coeffs(coeffs), _activity_aware(activity_aware),
+        _quiet(0), _idle(false)
+    {
+        assert(N > 0);
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        for (unsigned i=0; i < N; i++)
+            _delay_line[i] = 0;
+    }
+
+private:
+    T _delay_line[N];
+    const T* _coeffs;
+    const bool _activity_aware;
+    unsigned _quiet;  // number of consecutive repeated samples
+    bool _idle;       // waiting for an input change
+
+    void main() {
+        if (_idle) {
+            // woken up by an input change rather than by the clock:
+            // unless this is also a clock edge, go back to the static
+            // sensitivity and sample the input at the next edge
+            _idle = false;
+            if (!clock.posedge()) {
+                next_trigger();
+                return;
+            }
+        }
+
+        // read new data sample
+        T sample = in.read();
+        if (sample == _delay_line[0]) {
+            if (_quiet < N)
+                _quiet++;
+        } else
+            _quiet = 0;
+
+        // shift samples within delay line
+        for (unsigned j=N-1; j > 0; j--)
+            _delay_line[j] = _delay_line[j-1];
+
+        _delay_line[0] = sample;
+
+        // compute fir output
+        T sum = 0;
+        for (unsigned i=0; i < N; i++)
+            sum += _delay_line[i] * _coeffs[i];
+
+        out.write(sum);
+
+        if (_activity_aware && _quiet >= N-1) {
+            // all N samples in the delay line are equal, so every
+            // further clock edge would recompute the same output
+            _idle = true;
+            next_trigger(in.value_changed_event());
+        }
+    } 
+};
+
+#endif
@@ -0,0 +1,391 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+#include "../6_3_1/fir_compile_time.h"
+
+#ifdef FIR_BANK_THREADS
+#include <pthread.h>
+#include <vector>
+#endif
+
+// class template "fir_bank"
+//   C channels of the compile-time FIR of 6_3_1 in a single module.
+//   All channels share one coefficient array and one SC_METHOD.
+//   The delay lines are stored as a structure of arrays: row "i"
+//   holds tap "i" of every channel, so the inner loop runs over
+//   contiguous memory across channels and can be vectorized by
+//   the compiler. Rows form a ring buffer, so a new sample costs
+//   one row write instead of shifting N*C values.
+//
+// Template Parameters:
+//   class T - specifies the data-type used within the FIR
+//     (same requirements as for "fir" in 6_3_1)
+//   unsigned N - specifies the number of taps in FIR
+//     N must be greater than zero
+//   unsigned C - specifies the number of channels
+//     C must be greater than zero
+//
+// Constructor parameters:
+//   sc_module_name name - specifies instance name
+//   const T* coeffs - pointer to coefficient array
+//     coeffs array must contain N coefficients
+//   unsigned threads - number of threads the channels are split
+//     across. Only used when compiled with -DFIR_BANK_THREADS
+//     (link with -lpthread). T must then be a builtin type, as
+//     the fixed-point types are not thread-safe.
+//
+//   The channels are computed in chunks, one per thread. Every chunk
+//   has its own outputs in "_sum", at least a cache line away from
+//   those of the next chunk, so two threads never write to the same
+//   cache line.
+
+template <class T, unsigned N, unsigned C> class fir_bank: public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in[C];
+    sc_out<T> out[C];
+
+    SC_HAS_PROCESS(fir_bank);
+
+    fir_bank(sc_module_name name, const T* coeffs, unsigned threads = 1) :
+        sc_module(name), _coeffs(coeffs), _head(0), _chunk(C)
+    {
+        assert(N > 0); assert(C > 0);
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        _delay_line = new T[N * C];
+        for (unsigned i=0; i < N * C; i++)
+            _delay_line[i] = 0;
+
+#ifdef FIR_BANK_THREADS
+        if (threads > 1)
+            _chunk = (C + threads - 1) / threads;
+#endif
+        _sum = new T[sum_index(C - 1) + 1];
+
+#ifdef FIR_BANK_THREADS
+        start_workers();
+#endif
+    }
+
+    ~fir_bank()
+    {
+#ifdef FIR_BANK_THREADS
+        stop_workers();
+#endif
+        delete[] _delay_line;
+        delete[] _sum;
+    }
+
+private:
+    // "_sum" entries between two chunks: at least a cache line
+    enum { CACHE_LINE = 64,
+           SUM_PAD = (CACHE_LINE + sizeof(T) - 1) / sizeof(T) };
+
+    T* _delay_line;  // N rows of C samples, newest row at _head
+    T* _sum;         // one output per channel, see sum_index()
+    const T* _coeffs;
+    unsigned _head;
+    unsigned _chunk; // channels per thread
+
+    // position of the output of channel "c" in "_sum"
+    unsigned sum_index(unsigned c) const {
+        return c + (c / _chunk) * SUM_PAD;
+    }
+
+    void main() {
+        // the oldest row becomes the newest one
+        _head = (_head == 0) ? N-1 : _head-1;
+
+        // read new data samples
+        T* x = &_delay_line[_head * C];
+        for (unsigned c=0; c < C; c++)
+            x[c] = in[c].read();
+
+        // compute fir outputs
+#ifdef FIR_BANK_THREADS
+        if (!_workers.empty())
+            run_workers();
+        else
+#endif
+        compute(0, C);
+
+        for (unsigned c=0; c < C; c++)
+            out[c].write(_sum[sum_index(c)]);
+    }
+
+    // computes the outputs of channels c0 .. c1-1, which are in
+    // one chunk
+    void compute(unsigned c0, unsigned c1) {
+        T* sum = &_sum[sum_index(c0)] - c0;
+        for (unsigned c=c0; c < c1; c++)
+            sum[c] = 0;
+
+        unsigned row = _head;
+        for (unsigned i=0; i < N; i++) {
+            const T* x = &_delay_line[row * C];
+            const T k = _coeffs[i];
+            for (unsigned c=c0; c < c1; c++)
+                sum[c] += x[c] * k;
+            if (++row == N)
+                row = 0;
+        }
+    }
+
+#ifdef FIR_BANK_THREADS
+    // Worker threads only touch the delay lines and sums, never
+    // the ports or the simulation kernel. Each one owns a fixed
+    // range of channels; the calling thread computes the first.
+
+    struct worker {
+        fir_bank* bank;
+        unsigned c0, c1;
+        pthread_t thread;
+    };
+
+    std::vector<worker> _workers;
+    pthread_mutex_t _mutex;
+    pthread_cond_t _start, _done;
+    unsigned _generation, _pending;
+    bool _quit;
+
+    void start_workers() {
+        if (_chunk >= C)
+            return;
+
+        _generation = _pending = 0;
+        _quit = false;
+        pthread_mutex_init(&_mutex, 0);
+        pthread_cond_init(&_start, 0);
+        pthread_cond_init(&_done, 0);
+
+        for (unsigned c0=_chunk; c0 < C; c0 += _chunk) {
+            worker w;
+            w.bank = this;
+            w.c0 = c0;
+            w.c1 = (c0 + _chunk < C) ? c0 + _chunk : C;
+            _workers.push_back(w);
+        }
+        for (unsigned k=0; k < _workers.size(); k++)
+            pthread_create(&_workers[k].thread, 0, worker_main, &_workers[k]);
+    }
+
+    void stop_workers() {
+        if (_workers.empty())
+            return;
+
+        pthread_mutex_lock(&_mutex);
+        _quit = true;
+        pthread_cond_broadcast(&_start);
+        pthread_mutex_unlock(&_mutex);
+
+        for (unsigned k=0; k < _workers.size(); k++)
+            pthread_join(_workers[k].thread, 0);
+
+        pthread_cond_destroy(&_start);
+        pthread_cond_destroy(&_done);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    void run_workers() {
+        pthread_mutex_lock(&_mutex);
+        _pending = _workers.size();
+        _generation++;
+        pthread_cond_broadcast(&_start);
+        pthread_mutex_unlock(&_mutex);
+
+        compute(0, _chunk);
+
+        pthread_mutex_lock(&_mutex);
+        while (_pending > 0)
+            pthread_cond_wait(&_done, &_mutex);
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    static void* worker_main(void* arg) {
+        worker* w = (worker*) arg;
+        fir_bank* b = w->bank;
+        unsigned seen = 0;
+
+        pthread_mutex_lock(&b->_mutex);
+        while (true) {
+            while (b->_generation == seen && !b->_quit)
+                pthread_cond_wait(&b->_start, &b->_mutex);
+            if (b->_quit)
+                break;
+            seen = b->_generation;
+            pthread_mutex_unlock(&b->_mutex);
+
+            b->compute(w->c0, w->c1);
+
+            pthread_mutex_lock(&b->_mutex);
+            if (--b->_pending == 0)
+                pthread_cond_signal(&b->_done);
+        }
+        pthread_mutex_unlock(&b->_mutex);
+        return 0;
+    }
+#endif
+};
+
+// simple stimulus generator: channel "c" receives an
+// impulse of height 2*(c+1)
+
+template <class T, unsigned C> class stimulus : public sc_module {
+public:
+    sc_out<T> out[C];
+
+    SC_HAS_PROCESS(stimulus);
+
+    stimulus(sc_module_name name) : sc_module(name) {
+        SC_THREAD(main);
+    }
+
+    void main() {
+        unsigned c;
+        for (c=0; c < C; c++)
+            out[c].write(0);
+        wait(10, SC_NS);
+        for (c=0; c < C; c++)
+            out[c].write(2 * (c+1));
+        wait(1, SC_NS);
+        for (c=0; c < C; c++)
+            out[c].write(0);
+    }
+};
+
+// simple response logger
+
+template <class T> class response : public sc_module {
+public:
+    sc_in<T> in;
+
+    SC_HAS_PROCESS(response);
+
+    response(sc_module_name name) : sc_module(name) {
+        SC_METHOD(main);
+        sensitive << in;
+    }
+
+    void main() {
+        cout << name() << " at time: " << sc_time_stamp() << " output: " 
+             << in.read() << endl;
+    }
+};
+
+// compare: reports and counts every clock cycle in which two
+//   outputs differ
+
+template <class T> class compare : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in1, in2;
+
+    SC_HAS_PROCESS(compare);
+
+    compare(sc_module_name name) : sc_module(name), _errors(0) {
+        SC_METHOD(main);
+        sensitive << clock.neg();
+    }
+
+    unsigned errors() const { return _errors; }
+
+private:
+    unsigned _errors;
+
+    void main() {
+        if (!(in1.read() == in2.read())) {
+            cout << name() << " at time: " << sc_time_stamp()
+                 << " mismatch: " << in1.read() << " != " << in2.read()
+                 << endl;
+            _errors++;
+        }
+    }
+};
+
+// usage: fir_bank [threads]
+//   Every channel of the bank is compared with a "fir" of 6_3_1 on
+//   the same input. The bank splits the channels across "threads"
+//   threads (default 2) when compiled with -DFIR_BANK_THREADS.
+
+int sc_main (int argc , char *argv[]) 
+{
+    typedef double fir_T;
+ 
+    const fir_T coeffs[] = {1.1111, 2.2222, 3.3333, 4.4444};
+    const unsigned taps = sizeof(coeffs) / sizeof(coeffs[0]);
+    const unsigned channels = 4;
+    unsigned threads = 2;
+    char buf[10];
+
+    if (argc > 1) threads = atoi(argv[1]);
+
+    sc_clock clock("c1", 1, SC_NS);
+    sc_signal<fir_T> fir_in[channels];
+    sc_signal<fir_T> fir_out[channels];
+    sc_signal<fir_T> ref_out[channels];
+    compare<fir_T>* cmp[channels];
+
+    fir_bank<fir_T, taps, channels> bank1("bank1", &coeffs[0], threads);
+    bank1.clock(clock);
+
+    stimulus<fir_T, channels> stim1("stim1");
+
+    for (unsigned c=0; c < channels; c++) {
+        bank1.in[c](fir_in[c]);
+        bank1.out[c](fir_out[c]);
+        stim1.out[c](fir_in[c]);
+
+        sprintf(buf, "resp%d", c);
+        response<fir_T>* respp = new response<fir_T>(buf);
+        respp->in(fir_out[c]);
+
+        sprintf(buf, "ref%d", c);
+        fir<fir_T, taps>* refp = new fir<fir_T, taps>(buf, &coeffs[0]);
+        refp->clock(clock);
+        refp->in(fir_in[c]);
+        refp->out(ref_out[c]);
+
+        sprintf(buf, "cmp%d", c);
+        cmp[c] = new compare<fir_T>(buf);
+        cmp[c]->clock(clock);
+        cmp[c]->in1(fir_out[c]);
+        cmp[c]->in2(ref_out[c]);
+    }
+
+    sc_start(100, SC_NS);
+
+    unsigned errors = 0;
+    for (unsigned c=0; c < channels; c++)
+        errors += cmp[c]->errors();
+    cout << "fir_bank: " << errors << " mismatches" << endl;
+    return errors ? 1 : 0;
+}
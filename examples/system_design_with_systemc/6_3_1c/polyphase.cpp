@@ -0,0 +1,388 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+#include "../6_3_1/fir_compile_time.h"
+
+// Polyphase multirate versions of the compile-time FIR of 6_3_1.
+//
+// The N coefficients h[0..N-1] are split into sub-filters
+// h[p], h[p+F], h[p+2F], ... (F is the rate change factor), each
+// stored contiguously. Only output samples that are actually
+// produced are computed, and zero products are never formed, so
+// the cost per input (decimator) or per output (interpolator)
+// is about N/F multiply-accumulates instead of N.
+
+// class template "fir_decimator"
+//   Equivalent to the FIR of 6_3_1 followed by keeping every
+//   M-th output: "in" is sampled on every rising clock edge, and
+//   "out" is updated on every M-th edge (the first one included).
+//
+// Template Parameters:
+//   class T - specifies the data-type used within the FIR
+//     (same requirements as for "fir" in 6_3_1)
+//   unsigned N - specifies the number of taps in FIR
+//     N must be greater than zero
+//   unsigned M - specifies the decimation factor
+//     M must be greater than zero
+//
+// Constructor parameters:
+//   sc_module_name name - specifies instance name
+//   const T* coeffs - pointer to coefficient array
+//     coeffs array must contain N coefficients
+
+template <class T, unsigned N, unsigned M> class fir_decimator
+: public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in;
+    sc_out<T> out;
+
+    SC_HAS_PROCESS(fir_decimator);
+
+    fir_decimator(sc_module_name name, const T* coeffs) :
+        sc_module(name), _phase(0)
+    {
+        assert(N > 0); assert(M > 0);
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        // sub-filter p holds taps p, p+M, p+2M, ...
+        for (unsigned p=0; p < M; p++) {
+            for (unsigned k=0; k < K; k++) {
+                _delay_line[p][k] = 0;
+                if (k*M + p < N)
+                    _coeffs[p][k] = coeffs[k*M + p];
+                else
+                    _coeffs[p][k] = 0;
+            }
+        }
+    }
+
+private:
+    enum { K = (N + M - 1) / M }; // taps per sub-filter
+
+    T _delay_line[M][K];
+    T _coeffs[M][K];
+    unsigned _phase; // sub-filter receiving the next sample
+
+    void main() {
+        // shift the new sample into the delay line of its phase
+        T* line = _delay_line[_phase];
+        for (unsigned j=K-1; j > 0; j--)
+            line[j] = line[j-1];
+        line[0] = in.read();
+
+        if (_phase > 0) {
+            _phase--;
+            return;
+        }
+
+        // phase 0 has just received the newest sample:
+        // compute the one output that is kept
+        T sum = 0;
+        for (unsigned p=0; p < M; p++)
+            for (unsigned k=0; k < K; k++)
+                sum += _delay_line[p][k] * _coeffs[p][k];
+
+        out.write(sum);
+        _phase = M-1;
+    }
+};
+
+// class template "fir_interpolator"
+//   Equivalent to inserting L-1 zeros after every input sample
+//   and filtering the result with the FIR of 6_3_1. The clock
+//   runs at the output rate: "in" is sampled on every L-th
+//   rising clock edge (the first one included), and "out" is
+//   updated on every edge.
+//
+// Template Parameters:
+//   class T - specifies the data-type used within the FIR
+//     (same requirements as for "fir" in 6_3_1)
+//   unsigned N - specifies the number of taps in FIR
+//     N must be greater than zero
+//   unsigned L - specifies the interpolation factor
+//     L must be greater than zero
+//
+// Constructor parameters:
+//   sc_module_name name - specifies instance name
+//   const T* coeffs - pointer to coefficient array
+//     coeffs array must contain N coefficients
+
+template <class T, unsigned N, unsigned L> class fir_interpolator
+: public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in;
+    sc_out<T> out;
+
+    SC_HAS_PROCESS(fir_interpolator);
+
+    fir_interpolator(sc_module_name name, const T* coeffs) :
+        sc_module(name), _phase(0)
+    {
+        assert(N > 0); assert(L > 0);
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        for (unsigned k=0; k < K; k++)
+            _delay_line[k] = 0;
+
+        // sub-filter r holds taps r, r+L, r+2L, ...
+        for (unsigned r=0; r < L; r++) {
+            for (unsigned k=0; k < K; k++) {
+                if (k*L + r < N)
+                    _coeffs[r][k] = coeffs[k*L + r];
+                else
+                    _coeffs[r][k] = 0;
+            }
+        }
+    }
+
+private:
+    enum { K = (N + L - 1) / L }; // taps per sub-filter
+
+    T _delay_line[K];
+    T _coeffs[L][K];
+    unsigned _phase; // sub-filter computing the next output
+
+    void main() {
+        if (_phase == 0) {
+            // shift samples in delay line and read new data sample
+            for (unsigned j=K-1; j > 0; j--)
+                _delay_line[j] = _delay_line[j-1];
+            _delay_line[0] = in.read();
+        }
+
+        // only the non-zero samples of the upsampled
+        // stream take part in the sum
+        const T* coeffs = _coeffs[_phase];
+        T sum = 0;
+        for (unsigned k=0; k < K; k++)
+            sum += _delay_line[k] * coeffs[k];
+
+        out.write(sum);
+
+        if (++_phase == L)
+            _phase = 0;
+    }
+};
+
+// simple stimulus generator
+
+template <class T> class stimulus : public sc_module {
+public:
+    sc_out<T> out;
+
+    SC_HAS_PROCESS(stimulus);
+
+    stimulus(sc_module_name name) : sc_module(name) {
+        SC_THREAD(main);
+    }
+
+    void main() {
+        out.write(0);
+        wait(10, SC_NS);
+        out.write(2);
+        wait(2, SC_NS);
+        out.write(0);
+    }
+};
+
+// upsample: inserts L-1 zeros after every input sample, at the
+//   clock rate of fir_interpolator ("in" is sampled on the same
+//   edges). Feeds the full-rate reference of the interpolator.
+
+template <class T, unsigned L> class upsample : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in;
+    sc_out<T> out;
+
+    SC_HAS_PROCESS(upsample);
+
+    upsample(sc_module_name name) : sc_module(name), _phase(0) {
+        SC_METHOD(main);
+        sensitive << clock.pos();
+    }
+
+private:
+    unsigned _phase;
+
+    void main() {
+        out.write(_phase == 0 ? in.read() : T(0));
+        if (++_phase == L)
+            _phase = 0;
+    }
+};
+
+// multirate_check: compares the polyphase filters with the full-rate
+//   "fir" of 6_3_1. It runs on the same rising edges as the filters,
+//   so it sees their outputs of the previous edge:
+//     dec_ref - "fir" on the input; "dec" must hold its output of
+//               every M-th edge (the first one included)
+//     int_ref - "fir" on the output of "upsample", which is one
+//               edge late, so it is compared with "intp" of the
+//               edge before
+//   The sums are formed in a different order, so outputs may
+//   differ by a rounding error; larger differences are reported
+//   and counted in errors().
+
+template <class T, unsigned M, unsigned L> class multirate_check
+: public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> dec, dec_ref;
+    sc_in<T> intp, int_ref;
+
+    SC_HAS_PROCESS(multirate_check);
+
+    multirate_check(sc_module_name name) :
+        sc_module(name), _edge(0), _dec_expected(0), _int_prev(0),
+        _errors(0)
+    {
+        SC_METHOD(main);
+        sensitive << clock.pos();
+    }
+
+    unsigned errors() const { return _errors; }
+
+private:
+    unsigned _edge;
+    T _dec_expected;
+    T _int_prev;
+    unsigned _errors;
+
+    void compare(const char* what, const T& got, const T& expected) {
+        double d = double(got) - double(expected);
+        if (d > 1e-9 || d < -1e-9) {
+            cout << name() << " at time: " << sc_time_stamp() << " " << what
+                 << " mismatch: " << got << " != " << expected << endl;
+            _errors++;
+        }
+    }
+
+    void main() {
+        if (_edge > 0) {
+            if ((_edge - 1) % M == 0)
+                _dec_expected = dec_ref.read();
+            compare("decimator", dec.read(), _dec_expected);
+            if (_edge > 1)
+                compare("interpolator", _int_prev, int_ref.read());
+            _int_prev = intp.read();
+        }
+        _edge++;
+    }
+};
+
+// simple response logger
+
+template <class T> class response : public sc_module {
+public:
+    sc_in<T> in;
+
+    SC_HAS_PROCESS(response);
+
+    response(sc_module_name name) : sc_module(name) {
+        SC_METHOD(main);
+        sensitive << in;
+    }
+
+    void main() {
+        cout << name() << " at time: " << sc_time_stamp() << " output: " 
+             << in.read() << endl;
+    }
+};
+
+int sc_main (int argc , char *argv[]) 
+{
+    typedef double fir_T;
+ 
+    const fir_T coeffs[] = {1.1111, 2.2222, 3.3333, 4.4444,
+                            4.4444, 3.3333, 2.2222, 1.1111};
+    const unsigned taps = sizeof(coeffs) / sizeof(coeffs[0]);
+    const unsigned factor = 2;
+
+    sc_clock clock("c1", 1, SC_NS);
+    sc_signal<fir_T> fir_in;
+    sc_signal<fir_T> dec_out;
+    sc_signal<fir_T> int_out;
+    sc_signal<fir_T> ref_dec_out;
+    sc_signal<fir_T> up_out;
+    sc_signal<fir_T> ref_int_out;
+
+    fir_decimator<fir_T, taps, factor> dec1("dec1", &coeffs[0]);
+    dec1.clock(clock);
+    dec1.in(fir_in);
+    dec1.out(dec_out);
+
+    fir_interpolator<fir_T, taps, factor> int1("int1", &coeffs[0]);
+    int1.clock(clock);
+    int1.in(fir_in);
+    int1.out(int_out);
+
+    stimulus<fir_T> stim1("stim1");
+    stim1.out(fir_in);
+
+    response<fir_T> resp1("resp1");
+    resp1.in(dec_out);
+
+    response<fir_T> resp2("resp2");
+    resp2.in(int_out);
+
+    // references: the full-rate FIR followed by decimation, and
+    // upsampling followed by the full-rate FIR
+    fir<fir_T, taps> ref1("ref1", &coeffs[0]);
+    ref1.clock(clock);
+    ref1.in(fir_in);
+    ref1.out(ref_dec_out);
+
+    upsample<fir_T, factor> up1("up1");
+    up1.clock(clock);
+    up1.in(fir_in);
+    up1.out(up_out);
+
+    fir<fir_T, taps> ref2("ref2", &coeffs[0]);
+    ref2.clock(clock);
+    ref2.in(up_out);
+    ref2.out(ref_int_out);
+
+    multirate_check<fir_T, factor, factor> check1("check1");
+    check1.clock(clock);
+    check1.dec(dec_out);
+    check1.dec_ref(ref_dec_out);
+    check1.intp(int_out);
+    check1.int_ref(ref_int_out);
+
+    sc_start(100, SC_NS);
+
+    cout << "polyphase: " << check1.errors() << " mismatches" << endl;
+    return check1.errors() ? 1 : 0;
+}
@@ -28,72 +28,7 @@
 
 #define SC_INCLUDE_FX
 #include <systemc.h>
-
-// module "fir"
-// Constructor parameters:
-//   sc_module_name name - specifies instance name
-//   const double* coeffs - pointer to coefficient array
-//     coeffs array must contain "n" coefficients
-//   unsigned w - total bit width of fixed pt type used
-//   unsigned I - number of integer bits of fixed pt type
-//   unsigned n - number of taps in FIR
-
-class fir : public sc_module {
-public:
-    sc_in<bool> clock;
-
-    // For the sake of simplicity, the "sc_fix" data-type 
-    // is only used inside this module, and all external
-    // interfaces rely on "double"
-
-    sc_in<double> in;
-    sc_out<double> out;
-
-    SC_HAS_PROCESS(fir);
-
-    fir(sc_module_name name, const double* coeffs, unsigned w,
-        unsigned i, unsigned n) : 
-        sc_module(name), _w(w), _i(i), _n(n) 
-    {
-        assert(n > 0); assert(w > 0);
-        SC_METHOD(main);
-        sensitive << clock.pos();
-
-        // see discussion below for explanation of next line
-        sc_fxtype_context c1(sc_fxtype_params(_w, _i));
-        _delay_line = new sc_fix[_n];
-        _coeffs = new sc_fix[_n];
-
-        // copy input coeffs array and convert to sc_fix type
-        for (unsigned j=0; j < _n; j++)
-            _coeffs[j] = coeffs[j];
-    }
-
-    ~fir() { delete[] _delay_line; delete[] _coeffs; }
-
-private:
-    sc_fix *_delay_line;
-    sc_fix *_coeffs;
-    const unsigned _w, _i, _n;
-  
-    void main() {
-        // shift samples in delay line
-        for (int j=_n-1; j > 0; j--)
-            _delay_line[j] = _delay_line[j-1];
-
-        // read new data sample
-        _delay_line[0] = in.read();
-
-        // compute fir output
-        sc_fix sum(_w, _i);
-        sum = 0;
-        for (unsigned i=0; i < _n; i++)
-            sum += _delay_line[i] * _coeffs[i];
-
-        out.write(sum);
-    }
-};
-
+#include "fir_elab_time.h"
 
 // simple stimulus generator
 
@@ -162,6 +97,10 @@ int sc_main (int argc , char *argv[])
     resp1.in(fir_out);
 
     sc_start(100, SC_NS);
+
+#ifdef FX_STATS
+    fir1.print_stats();
+#endif
     return 0;
 }
 
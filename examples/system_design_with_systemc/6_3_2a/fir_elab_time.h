@@ -0,0 +1,191 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef FIR_ELAB_TIME_H
+#define FIR_ELAB_TIME_H
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+#include <math.h>
+
+// fx_stats: statistics for one fixed-point variable
+//   Every record() call passes the value just assigned to the
+//   variable together with the exact value that was assigned.
+//   Collected are the range of the exact values (to size the
+//   integer bits), the number of overflows, and the mean and
+//   variance of the quantization error of the assignments that
+//   did not overflow.
+//
+//   Statistics are only compiled in when FX_STATS is defined
+//   (e.g. -DFX_STATS); otherwise FX_STATS_RECORD() expands to
+//   nothing and its arguments are not evaluated.
+
+#ifdef FX_STATS
+
+class fx_stats {
+public:
+    fx_stats() : _count(0), _overflows(0), _min(HUGE_VAL), _max(-HUGE_VAL),
+        _err_count(0), _err_mean(0), _err_m2(0) {}
+
+    void record(const sc_fxnum& v, double exact) {
+        _count++;
+        if (exact < _min) _min = exact;
+        if (exact > _max) _max = exact;
+
+        if (v.overflow_flag()) {
+            _overflows++;
+            return;
+        }
+
+        // running mean and variance (Welford)
+        double e = v.to_double() - exact;
+        double delta = e - _err_mean;
+        _err_count++;
+        _err_mean += delta / _err_count;
+        _err_m2 += delta * (e - _err_mean);
+    }
+
+    unsigned long overflows() const { return _overflows; }
+
+    void print(const char* name) const {
+        cout << name << ": " << _count << " values";
+        if (_count > 0)
+            cout << " in [" << _min << ", " << _max << "], "
+                 << _overflows << " overflows";
+        if (_err_count > 0)
+            cout << ", quantization error mean " << _err_mean
+                 << " variance " << _err_m2 / _err_count;
+        cout << endl;
+    }
+
+private:
+    unsigned long _count, _overflows;
+    double _min, _max;
+    unsigned long _err_count;
+    double _err_mean, _err_m2;
+};
+
+#define FX_STATS_RECORD(stats, v, exact) (stats).record(v, exact)
+
+#else
+
+#define FX_STATS_RECORD(stats, v, exact)
+
+#endif
+
+// module "fir"
+// Constructor parameters:
+//   sc_module_name name - specifies instance name
+//   const double* coeffs - pointer to coefficient array
+//     coeffs array must contain "n" coefficients
+//   unsigned w - total bit width of fixed pt type used
+//   unsigned I - number of integer bits of fixed pt type
+//   unsigned n - number of taps in FIR
+
+class fir : public sc_module {
+public:
+    sc_in<bool> clock;
+
+    // For the sake of simplicity, the "sc_fix" data-type 
+    // is only used inside this module, and all external
+    // interfaces rely on "double"
+
+    sc_in<double> in;
+    sc_out<double> out;
+
+    SC_HAS_PROCESS(fir);
+
+    fir(sc_module_name name, const double* coeffs, unsigned w,
+        unsigned i, unsigned n) : 
+        sc_module(name), _w(w), _i(i), _n(n) 
+    {
+        assert(n > 0); assert(w > 0);
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        // see discussion below for explanation of next line
+        sc_fxtype_context c1(sc_fxtype_params(_w, _i));
+        _delay_line = new sc_fix[_n];
+        _coeffs = new sc_fix[_n];
+
+        // copy input coeffs array and convert to sc_fix type
+        for (unsigned j=0; j < _n; j++) {
+            _coeffs[j] = coeffs[j];
+            FX_STATS_RECORD(_coeffs_stats, _coeffs[j], coeffs[j]);
+        }
+    }
+
+    ~fir() { delete[] _delay_line; delete[] _coeffs; }
+
+#ifdef FX_STATS
+    void print_stats() const {
+        _delay_line_stats.print("_delay_line");
+        _coeffs_stats.print("_coeffs");
+        _sum_stats.print("sum");
+    }
+
+    // overflows of all fixed-point variables so far
+    unsigned long overflows() const {
+        return _delay_line_stats.overflows() + _coeffs_stats.overflows()
+               + _sum_stats.overflows();
+    }
+#endif
+
+private:
+    sc_fix *_delay_line;
+    sc_fix *_coeffs;
+    const unsigned _w, _i, _n;
+
+#ifdef FX_STATS
+    fx_stats _delay_line_stats, _coeffs_stats, _sum_stats;
+#endif
+  
+    void main() {
+        // shift samples in delay line
+        for (int j=_n-1; j > 0; j--)
+            _delay_line[j] = _delay_line[j-1];
+
+        // read new data sample
+        _delay_line[0] = in.read();
+        FX_STATS_RECORD(_delay_line_stats, _delay_line[0], in.read());
+
+        // compute fir output
+        sc_fix sum(_w, _i);
+        sum = 0;
+        for (unsigned i=0; i < _n; i++) {
+#ifdef FX_STATS
+            double exact = sum.to_double()
+                           + (_delay_line[i] * _coeffs[i]).to_double();
+#endif
+            sum += _delay_line[i] * _coeffs[i];
+            FX_STATS_RECORD(_sum_stats, sum, exact);
+        }
+
+        out.write(sum);
+    }
+};
+
+#endif
@@ -0,0 +1,68 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <stdlib.h>
+#include <new>
+
+// alloc_count: counts the bytes requested from the heap through
+//   operator new (and so through new[], which calls it), so that
+//   the memory used by modules, ports, processes and their
+//   internal arrays can be measured.
+//
+//   The counting operator new and delete are defined by
+//   ALLOC_COUNT_DEFINE_OPERATOR_NEW, which must be used once, at
+//   file scope, in one source file of the program. Without it
+//   alloc_count_bytes() stays zero.
+
+inline unsigned long& alloc_count_bytes()
+{
+    static unsigned long bytes = 0;
+    return bytes;
+}
+
+#if __cplusplus < 201103L
+#define ALLOC_COUNT_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define ALLOC_COUNT_NOTHROW throw()
+#else
+#define ALLOC_COUNT_THROW_BAD_ALLOC
+#define ALLOC_COUNT_NOTHROW noexcept
+#endif
+
+#define ALLOC_COUNT_DEFINE_OPERATOR_NEW \
+    void* operator new(size_t size) ALLOC_COUNT_THROW_BAD_ALLOC \
+    { \
+        alloc_count_bytes() += size; \
+        void* p = malloc(size ? size : 1); \
+        if (!p) \
+            throw std::bad_alloc(); \
+        return p; \
+    } \
+    void operator delete(void* p) ALLOC_COUNT_NOTHROW { free(p); }
+
+#endif
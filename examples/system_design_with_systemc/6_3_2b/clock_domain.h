@@ -0,0 +1,146 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+#ifndef CLOCK_DOMAIN_H
+#define CLOCK_DOMAIN_H
+
+#include <systemc.h>
+#include <string.h>
+#include <vector>
+
+// class template "clock_domain"
+//   Evaluates all registers clocked by one clock in a single
+//   SC_METHOD. A register is not a module: it is one entry in
+//   flat arrays that hold the slot its D input reads from, and
+//   its Q value. On every activation (initialization and every
+//   rising clock edge, like an SC_METHOD sensitive to clock.pos())
+//   the domain
+//     1. samples its input ports into their slots,
+//     2. samples the D input of every register,
+//     3. commits every Q at once (one contiguous copy), and
+//     4. writes the output ports.
+//   Only the output ports cause kernel update requests.
+//
+//   Step 2 is one load and one store per register. It runs in
+//   the simulation thread: splitting it across threads would cost
+//   a hand-off per edge that only very large domains on several
+//   cores could win back.
+//
+//   Values live in numbered slots: slots 0 .. n_in-1 are the input
+//   ports, the following slots are the Q outputs of the registers
+//   in creation order.
+//
+// Template Parameters:
+//   class T - data-type stored in the registers
+//
+// Constructor parameters:
+//   sc_module_name name - specifies instance name
+//   unsigned n_in - number of input ports, in(0) .. in(n_in-1)
+//   unsigned n_out - number of output ports, out(0) .. out(n_out-1)
+
+template <class T> class clock_domain : public sc_module {
+public:
+    sc_in<bool> clock;
+
+    SC_HAS_PROCESS(clock_domain);
+
+    clock_domain(sc_module_name name, unsigned n_in, unsigned n_out)
+      : sc_module(name), _n_in(n_in), _n_out(n_out)
+    {
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        _inputs = new sc_in<T>[_n_in];
+        _outputs = new sc_out<T>[_n_out];
+        _value.resize(_n_in, T());
+        _out_slot.resize(_n_out, 0);
+    }
+
+    ~clock_domain()
+    {
+        delete[] _inputs;
+        delete[] _outputs;
+    }
+
+    sc_in<T>& in(unsigned i) { return _inputs[i]; }
+    sc_out<T>& out(unsigned o) { return _outputs[o]; }
+
+    unsigned input_slot(unsigned i) const { return i; }
+
+    // adds a register whose D input reads slot "d";
+    // returns the slot of its Q output
+    unsigned add_reg(unsigned d, const T& init = T())
+    {
+        assert(d < _value.size());
+        _d.push_back(d);
+        _next.push_back(init);
+        _value.push_back(init);
+        return _value.size() - 1;
+    }
+
+    // output port "o" shows the value of slot "s"
+    void drive_output(unsigned o, unsigned s)
+    {
+        assert(o < _n_out && s < _value.size());
+        _out_slot[o] = s;
+    }
+
+    unsigned num_regs() const { return _d.size(); }
+
+    const T& value(unsigned s) const { return _value[s]; }
+
+private:
+    unsigned _n_in, _n_out;
+    sc_in<T>* _inputs;
+    sc_out<T>* _outputs;
+    std::vector<unsigned> _out_slot;
+
+    std::vector<T> _value;     // all slots: inputs, then register Qs
+    std::vector<unsigned> _d;  // D input slot of every register
+    std::vector<T> _next;      // sampled D values
+
+    void main()
+    {
+        unsigned i, k, n = _d.size();
+
+        for (i=0; i < _n_in; i++)
+            _value[i] = _inputs[i].read();
+
+        for (k=0; k < n; k++)
+            _next[k] = _value[_d[k]];
+
+        // register Qs are contiguous, starting after the inputs
+        for (k=0; k < n; k++)
+            _value[_n_in + k] = _next[k];
+
+        for (i=0; i < _n_out; i++)
+            _outputs[i].write(_value[_out_slot[i]]);
+    }
+};
+
+#endif
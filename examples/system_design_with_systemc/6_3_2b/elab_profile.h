@@ -0,0 +1,214 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+#ifndef ELAB_PROFILE_H
+#define ELAB_PROFILE_H
+
+#include <systemc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <map>
+#include <string>
+#include "alloc_count.h"
+
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+
+// elab_profile: elaboration profiler
+//
+//   ELAB_PROFILE_SCOPE(category) measures the wall time and the heap
+//   bytes allocated from that point to the end of the enclosing
+//   block and adds them to "category". Scopes may be nested; the
+//   figures of an outer scope include those of its inner scopes.
+//   Heap bytes are counted by the replacement operator new of
+//   alloc_count.h, which the program defines with
+//   ELAB_PROFILE_DEFINE_OPERATOR_NEW.
+//
+//   An elab_profile_probe module prints the report, including the
+//   time from start_binding() to the end of elaboration and the
+//   number of objects of each kind, from its end_of_elaboration()
+//   callback, i.e. before the simulation starts.
+//
+//   Port binding with operator() only records the binding; SystemC
+//   resolves all of them when sc_start() completes the elaboration.
+//   So a scope around operator() measures the recording, and the
+//   resolution shows up as "binding resolution", which is the time
+//   from start_binding() (called right before sc_start()) to the
+//   end_of_elaboration() of the probe.
+//
+//   The profiler is only compiled in when ELAB_PROFILE is defined
+//   (e.g. -DELAB_PROFILE); otherwise ELAB_PROFILE_SCOPE() expands
+//   to nothing.
+
+#ifdef ELAB_PROFILE
+
+class elab_profile {
+public:
+    struct entry {
+        const char* name;
+        unsigned long count;
+        double seconds;
+        unsigned long bytes;
+    };
+
+    static entry& get(const char* name) {
+        // linear search over a fixed table: no heap allocation here
+        unsigned k;
+        for (k=0; k < used(); k++)
+            if (strcmp(table()[k].name, name) == 0)
+                return table()[k];
+
+        assert(used() < MAX_ENTRIES);
+        entry& e = table()[used()++];
+        e.name = name;
+        e.count = 0;
+        e.seconds = 0;
+        e.bytes = 0;
+        return e;
+    }
+
+    static unsigned long& bytes_allocated() {
+        return alloc_count_bytes();
+    }
+
+    static double now() {
+#ifdef _WIN32
+        return double(clock()) / CLOCKS_PER_SEC;
+#else
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec + 1e-6 * tv.tv_usec;
+#endif
+    }
+
+    // called right before sc_start()
+    static void start_binding() { binding_start() = now(); }
+
+    static void report() {
+        double binding = now() - binding_start();
+        char buf[128];
+
+        cout << endl << "elaboration profile:" << endl;
+        sprintf(buf, "%-20s %9s %12s %10s %12s %10s", "category", "count",
+                "total ms", "us each", "bytes", "bytes each");
+        cout << buf << endl;
+
+        for (unsigned k=0; k < used(); k++) {
+            const entry& e = table()[k];
+            sprintf(buf, "%-20s %9lu %12.3f %10.3f %12lu %10lu", e.name,
+                    e.count, 1e3 * e.seconds,
+                    e.count ? 1e6 * e.seconds / e.count : 0.0, e.bytes,
+                    e.count ? e.bytes / e.count : 0UL);
+            cout << buf << endl;
+        }
+
+        sprintf(buf, "%-20s %9s %12.3f", "binding resolution", "",
+                1e3 * binding);
+        cout << buf << endl;
+        cout << "heap bytes allocated before sc_start: "
+             << bytes_allocated() << endl;
+
+        // count all objects by kind
+        std::map<std::string, unsigned long> kinds;
+        sc_simcontext* c = sc_get_curr_simcontext();
+        for (sc_object* o = c->first_object(); o; o = c->next_object())
+            kinds[o->kind()]++;
+
+        cout << endl << "objects:" << endl;
+        std::map<std::string, unsigned long>::const_iterator i;
+        for (i = kinds.begin(); i != kinds.end(); ++i) {
+            sprintf(buf, "%-20s %9lu", i->first.c_str(), i->second);
+            cout << buf << endl;
+        }
+        cout << endl;
+    }
+
+private:
+    enum { MAX_ENTRIES = 32 };
+
+    static entry* table() {
+        static entry entries[MAX_ENTRIES];
+        return entries;
+    }
+
+    static unsigned& used() {
+        static unsigned n = 0;
+        return n;
+    }
+
+    static double& binding_start() {
+        static double t = 0;
+        return t;
+    }
+};
+
+class elab_profile_scope {
+public:
+    elab_profile_scope(const char* name)
+      : _entry(elab_profile::get(name)),
+        _bytes(elab_profile::bytes_allocated()),
+        _start(elab_profile::now()) {}
+
+    ~elab_profile_scope() {
+        _entry.count++;
+        _entry.seconds += elab_profile::now() - _start;
+        _entry.bytes += elab_profile::bytes_allocated() - _bytes;
+    }
+
+private:
+    elab_profile::entry& _entry;
+    unsigned long _bytes;
+    double _start;
+};
+
+class elab_profile_probe : public sc_module {
+public:
+    elab_profile_probe(sc_module_name name) : sc_module(name) {}
+
+    void end_of_elaboration() { elab_profile::report(); }
+};
+
+// the variable name contains the line number, so that several
+// scopes can be opened in one block, one per line
+#define ELAB_PROFILE_CAT2(a, b) a##b
+#define ELAB_PROFILE_CAT(a, b) ELAB_PROFILE_CAT2(a, b)
+#define ELAB_PROFILE_SCOPE(name) \
+    elab_profile_scope ELAB_PROFILE_CAT(elab_profile_scope_, __LINE__)(name)
+
+// to be used once, at file scope, in one source file of the program
+#define ELAB_PROFILE_DEFINE_OPERATOR_NEW ALLOC_COUNT_DEFINE_OPERATOR_NEW
+
+#else
+
+#define ELAB_PROFILE_SCOPE(name)
+
+#endif
+
+#endif
@@ -27,6 +27,90 @@
 
 
 #include <systemc.h>
+#include <new>
+#include <vector>
+#include "elab_profile.h"
+#include "clock_domain.h"
+#include "reg_signal.h"
+
+#ifdef ELAB_PROFILE
+ELAB_PROFILE_DEFINE_OPERATOR_NEW
+#endif
+
+// elab_arena: allocates the objects of a generated structure
+//   contiguously, in creation order, from large blocks. Destroying
+//   the arena destroys all objects in reverse creation order and
+//   then releases all blocks at once.
+
+class elab_arena {
+public:
+    elab_arena(size_t block_size = 64 * 1024)
+      : _block_size(block_size), _cur(0), _left(0) {}
+
+    ~elab_arena()
+    {
+        for (size_t k=_objects.size(); k > 0; k--)
+            _objects[k-1].destroy(_objects[k-1].object);
+        for (size_t k=0; k < _blocks.size(); k++)
+            delete[] _blocks[k];
+    }
+
+    template <class T> T* create()
+    {
+        T* p = new (allocate(sizeof(T))) T;
+        remember(p);
+        return p;
+    }
+
+    template <class T, class A> T* create(const A& a)
+    {
+        T* p = new (allocate(sizeof(T))) T(a);
+        remember(p);
+        return p;
+    }
+
+private:
+    enum { ALIGN = 16 };
+
+    struct entry {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    size_t _block_size;
+    char* _cur;
+    size_t _left;
+    std::vector<char*> _blocks;
+    std::vector<entry> _objects;
+
+    void* allocate(size_t size)
+    {
+        size = (size + ALIGN - 1) & ~size_t(ALIGN - 1);
+        if (size > _left) {
+            size_t n = size > _block_size ? size : _block_size;
+            _cur = new char[n];
+            _left = n;
+            _blocks.push_back(_cur);
+        }
+        void* p = _cur;
+        _cur += size;
+        _left -= size;
+        return p;
+    }
+
+    template <class T> static void destroy(void* p)
+    {
+        static_cast<T*>(p)->~T();
+    }
+
+    template <class T> void remember(T* p)
+    {
+        entry e;
+        e.destroy = &destroy<T>;
+        e.object = p;
+        _objects.push_back(e);
+    }
+};
 
 // reg: a simple register that stores an "int"
 
@@ -39,7 +123,11 @@ public:
     SC_HAS_PROCESS(reg);
 
     reg(sc_module_name name) : sc_module(name) {
-        SC_METHOD(main);
+        {
+            ELAB_PROFILE_SCOPE("reg process");
+            SC_METHOD(main);
+        }
+        ELAB_PROFILE_SCOPE("reg sensitivity");
         sensitive << clock.pos();
     }
 
@@ -48,7 +136,13 @@ public:
 
 // shiftreg: a shift register that stores "ints".
 //   Overall shift register length is set via
-//   its constructor argument
+//   its constructor argument. The "reg" instances and
+//   signals are placed in an arena owned by the shift
+//   register and are deleted together with it.
+//   The signals between the stages are reg_signals whose
+//   values share one reg_table, so a clock edge costs one
+//   update of the table, over the signals written, instead
+//   of one per signal.
 
 class shiftreg : public sc_module {
 public:
@@ -57,59 +151,182 @@ public:
     sc_out<int> out;
 
     shiftreg(sc_module_name name, unsigned len)
-      : sc_module(name) 
+      : sc_module(name), _table("table")
     {
-        char buf[10];
+        char buf[16];
 
         // "prev" points to the signal connected to the
         // output of the previous "reg" instance
 
-        sc_signal<int>* prev = 0;
+        reg_signal<int>* prev = 0;
 
         // loop to create and connect all the "reg" instances:
 
+        // the ELAB_PROFILE_SCOPE blocks only matter when
+        // compiled with -DELAB_PROFILE, see elab_profile.h;
+        // "port bind call" only times the recording of a
+        // binding, the bindings are resolved in sc_start()
+
         for (unsigned i=0; i < len; i++) 
         {
-            sprintf(buf, "r%d", i);
+            {
+                ELAB_PROFILE_SCOPE("name generation");
+                sprintf(buf, "r%d", i);
+            }
 
             // instantiate the "reg" instance
-            reg* regp = new reg(buf);
+            reg* regp;
+            {
+                ELAB_PROFILE_SCOPE("reg");
+                regp = _arena.create<reg>(buf);
+            }
 
             // connect the "clock" port of every instance
-            regp->clock(clock);
+            {
+                ELAB_PROFILE_SCOPE("port bind call");
+                regp->clock(clock);
+            }
 
             // if this is the first instance, connect the "reg"
             // input port to the "shiftreg" input port, else
             // connect the "reg" input port to the output 
             // signal of the previous "reg" instance
-            if (i == 0)
-                regp->in(in);
-            else
-                regp->in(*prev);
+            {
+                ELAB_PROFILE_SCOPE("port bind call");
+                if (i == 0)
+                    regp->in(in);
+                else
+                    regp->in(*prev);
+            }
 
             if (i < len - 1) {
                 // for each "reg" instance except the last,
                 // create a new signal and attach it to the 
                 // output port on "reg"
-                sc_signal<int>* sigp = new sc_signal<int>;
+                reg_signal<int>* sigp;
+                {
+                    ELAB_PROFILE_SCOPE("reg_signal<int>");
+                    sigp = _arena.create<reg_signal<int> >(&_table);
+                }
+                ELAB_PROFILE_SCOPE("port bind call");
                 regp->out(*sigp);
                 prev = sigp;
             }
             else {
               // connect the output port of the last "reg" 
               // instance to the output port of "shiftreg"
+               ELAB_PROFILE_SCOPE("port bind call");
                regp->out(out);
             }   
         }
     }
 
-    ~shiftreg()
+private:
+    reg_table<int> _table;
+    elab_arena _arena;
+};
+
+// shiftreg_folded: behaves cycle for cycle like "shiftreg", but
+//   the whole chain is a single module with one SC_METHOD and a
+//   ring buffer of "len" ints, so elaboration and the cost per
+//   clock edge do not depend on "len".
+//
+//   Optionally, the outputs of selected "reg" stages can be
+//   exposed: "taps" lists the stage numbers (0 is the first
+//   stage), and tap(k) is the output port of the k-th entry.
+
+class shiftreg_folded : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<int> in;
+    sc_out<int> out;
+
+    SC_HAS_PROCESS(shiftreg_folded);
+
+    shiftreg_folded(sc_module_name name, unsigned len,
+                    const unsigned* taps = 0, unsigned ntaps = 0)
+      : sc_module(name), _len(len), _pos(0), _ntaps(ntaps)
+    {
+        assert(len > 0);
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        _data = new int[_len];
+        for (unsigned i=0; i < _len; i++)
+            _data[i] = 0;
+
+        _taps = new unsigned[_ntaps];
+        _tap_ports = new sc_out<int>[_ntaps];
+        for (unsigned k=0; k < _ntaps; k++) {
+            assert(taps[k] < _len);
+            _taps[k] = taps[k];
+        }
+    }
+
+    ~shiftreg_folded()
     {
-        // a robust version would delete all the dynamically
-        // allocated signals and modules
+        delete[] _data;
+        delete[] _taps;
+        delete[] _tap_ports;
+    }
+
+    sc_out<int>& tap(unsigned k) { return _tap_ports[k]; }
+
+private:
+    int* _data;      // stage outputs, oldest sample at _pos
+    unsigned _len;
+    unsigned _pos;
+    unsigned* _taps;
+    sc_out<int>* _tap_ports;
+    unsigned _ntaps;
+
+    // one activation shifts every stage, like all "reg"
+    // instances of "shiftreg" do on the same event
+    void main() {
+        _data[_pos] = in.read();
+        if (++_pos == _len)
+            _pos = 0;
+
+        out.write(_data[_pos]);
+
+        // stage k holds the sample taken k activations ago
+        for (unsigned k=0; k < _ntaps; k++) {
+            unsigned i = _pos + _len - 1 - _taps[k];
+            _tap_ports[k].write(_data[i < _len ? i : i - _len]);
+        }
+    }
+};
+
+// shiftreg_batched: the same chain of "len" registers as
+//   "shiftreg", built as registers of one clock_domain (see
+//   clock_domain.h) instead of "reg" modules and signals, so a
+//   clock edge is one pass over flat arrays.
+
+class shiftreg_batched : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<int> in;
+    sc_out<int> out;
+
+    shiftreg_batched(sc_module_name name, unsigned len)
+      : sc_module(name), _domain("domain", 1, 1)
+    {
+        assert(len > 0);
+
+        unsigned slot = _domain.input_slot(0);
+        for (unsigned i=0; i < len; i++)
+            slot = _domain.add_reg(slot);
+        _domain.drive_output(0, slot);
+
+        _domain.clock(clock);
+        _domain.in(0)(in);
+        _domain.out(0)(out);
     }
+
+private:
+    clock_domain<int> _domain;
 };
- 
+
 // simple stimulus generator
 
 template <class T> class stimulus : public sc_module {
@@ -150,6 +367,36 @@ public:
     }
 };
 
+// compare: reports and counts every clock cycle in which two
+//   outputs differ
+
+template <class T> class compare : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<T> in1, in2;
+
+    SC_HAS_PROCESS(compare);
+
+    compare(sc_module_name name) : sc_module(name), _errors(0) {
+        SC_METHOD(main);
+        sensitive << clock.neg();
+    }
+
+    unsigned errors() const { return _errors; }
+
+private:
+    unsigned _errors;
+
+    void main() {
+        if (in1.read() != in2.read()) {
+            cout << name() << " at time: " << sc_time_stamp()
+                 << " mismatch: " << in1.read() << " != " << in2.read()
+                 << endl;
+            _errors++;
+        }
+    }
+};
+
 
 int sc_main (int argc , char *argv[])
 {
@@ -157,24 +404,72 @@ int sc_main (int argc , char *argv[])
 
     if (argc > 1) w = atoi(argv[1]);
     if (w < 1) w = 1;
-    if (w > 50) w = 50;
 
     sc_clock clock("c1", 1, SC_NS);
     sc_signal<int> shiftreg_in;
     sc_signal<int> shiftreg_out;
-
-    shiftreg sr1("sr1", w);
-    sr1.clock(clock);
-    sr1.in(shiftreg_in);
-    sr1.out(shiftreg_out);
+    sc_signal<int> folded_out;
+    sc_signal<int> batched_out;
+
+#ifdef ELAB_PROFILE
+    elab_profile_probe probe1("probe1");
+#endif
+
+    shiftreg_folded sr2("sr2", w);
+    sr2.clock(clock);
+    sr2.in(shiftreg_in);
+    sr2.out(folded_out);
+
+    shiftreg_batched sr3("sr3", w);
+    sr3.clock(clock);
+    sr3.in(shiftreg_in);
+    sr3.out(batched_out);
+
+    compare<int> cmp3("cmp3");
+    cmp3.clock(clock);
+    cmp3.in1(batched_out);
+    cmp3.in2(folded_out);
+
+    // the structural version is only built for short lengths,
+    // and its output is checked against the folded one
+
+    shiftreg* sr1 = 0;
+    compare<int>* cmp1 = 0;
+
+    if (w <= 50) {
+        ELAB_PROFILE_SCOPE("shiftreg");
+        sr1 = new shiftreg("sr1", w);
+        sr1->clock(clock);
+        sr1->in(shiftreg_in);
+        sr1->out(shiftreg_out);
+
+        cmp1 = new compare<int>("cmp1");
+        cmp1->clock(clock);
+        cmp1->in1(shiftreg_out);
+        cmp1->in2(folded_out);
+    }
 
     stimulus<int> stim1("stim1");
     stim1.out(shiftreg_in);
 
     response<int> resp1("resp1");
-    resp1.in(shiftreg_out);
+    resp1.in(folded_out);
 
+#ifdef ELAB_PROFILE
+    elab_profile::start_binding();
+#endif
     sc_start(100, SC_NS);
-    return 0;
+
+    unsigned errors = cmp3.errors();
+    cout << "shiftreg_batched: " << cmp3.errors() << " mismatches" << endl;
+    if (cmp1) {
+        errors += cmp1->errors();
+        cout << "shiftreg_folded: " << cmp1->errors() << " mismatches"
+             << endl;
+    }
+
+    delete cmp1;
+    delete sr1;
+    return errors ? 1 : 0;
 } 
 
@@ -0,0 +1,163 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+#ifndef REG_SIGNAL_H
+#define REG_SIGNAL_H
+
+#include <systemc.h>
+#include <vector>
+
+// class template "reg_table"
+//   Primitive channel that holds the current and the next value of
+//   many lightweight signals (see reg_signal below) in contiguous
+//   arrays. However many of them are written in a delta cycle, the
+//   table requests a single update. write() records the index of
+//   every signal written, once, and update() commits only those, so
+//   its cost is that of the writes and not of the table size.
+//
+//   A value-changed event is only created for a signal when some
+//   process asks for it (e.g. "sensitive << sig" or a dynamic
+//   wait), so signals nobody can be waiting on never notify.
+
+template <class T> class reg_table : public sc_prim_channel {
+public:
+    reg_table(const char* name) : sc_prim_channel(name), _pending(false) {}
+
+    ~reg_table()
+    {
+        for (unsigned k=0; k < _events.size(); k++)
+            delete _events[k];
+    }
+
+    // adds a signal and returns its index
+    unsigned add(const T& init)
+    {
+        _cur.push_back(init);
+        _next.push_back(init);
+        _changed.push_back(0);
+        _queued.push_back(0);
+        _events.push_back(0);
+        return _cur.size() - 1;
+    }
+
+    const T& read(unsigned i) const { return _cur[i]; }
+
+    void write(unsigned i, const T& v)
+    {
+        _next[i] = v;
+        if (!_queued[i]) {
+            _queued[i] = 1;
+            _written.push_back(i);
+        }
+        if (!_pending) {
+            _pending = true;
+            request_update();
+        }
+    }
+
+    bool event(unsigned i) const
+    {
+        return _changed[i] != 0 &&
+               _changed[i] == simcontext()->delta_count();
+    }
+
+    const sc_event& value_changed_event(unsigned i) const
+    {
+        if (!_events[i])
+            _events[i] = new sc_event;
+        return *_events[i];
+    }
+
+protected:
+    void update()
+    {
+        _pending = false;
+        uint64 now = simcontext()->delta_count() + 1;
+
+        // commit the written entries, stamp and notify the changed ones
+        for (unsigned k=0; k < _written.size(); k++) {
+            unsigned i = _written[k];
+            _queued[i] = 0;
+            if (!(_cur[i] == _next[i])) {
+                _cur[i] = _next[i];
+                _changed[i] = now;
+                if (_events[i])
+                    _events[i]->notify(SC_ZERO_TIME);
+            }
+        }
+        _written.clear();
+    }
+
+private:
+    std::vector<T> _cur, _next;
+    std::vector<uint64> _changed;             // delta of last change, plus one
+    std::vector<unsigned char> _queued;       // index is in _written
+    std::vector<unsigned> _written;           // written since the last update
+    mutable std::vector<sc_event*> _events;   // created on demand
+    bool _pending;
+};
+
+// class template "reg_signal"
+//   A signal for internal point-to-point connections, e.g. between
+//   the stages of a register chain. It implements the sc_signal
+//   interfaces so sc_in/sc_out ports bind to it, but it is not an
+//   sc_object and its value lives in a reg_table shared with many
+//   other signals.
+
+template <class T> class reg_signal : public sc_signal_inout_if<T> {
+public:
+    reg_signal(reg_table<T>* table, const T& init = T())
+      : _table(table), _index(table->add(init)) {}
+
+    const T& read() const { return _table->read(_index); }
+    const T& get_data_ref() const { return _table->read(_index); }
+    operator const T&() const { return read(); }
+
+    bool event() const { return _table->event(_index); }
+
+    const sc_event& value_changed_event() const
+    {
+        return _table->value_changed_event(_index);
+    }
+
+    const sc_event& default_event() const { return value_changed_event(); }
+
+    void write(const T& v) { _table->write(_index, v); }
+
+    reg_signal& operator=(const T& v)
+    {
+        write(v);
+        return *this;
+    }
+
+private:
+    reg_table<T>* _table;
+    unsigned _index;
+};
+
+#endif
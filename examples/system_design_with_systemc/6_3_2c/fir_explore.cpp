@@ -0,0 +1,445 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+// Word-length exploration for the elaboration-time FIR of 6_3_2a.
+//
+// Rather than running 6_3_2a/run.x once per (w, i) point, this
+// example elaborates many "fir" configurations side by side,
+// feeds them from one shared stimulus, and compares every output
+// against a double-precision reference filter. The (w, i) grid is
+// dealt out to one worker process per CPU; each worker builds and
+// simulates its own slice and reports back through a pipe.
+//
+// Usage: run.x [w_min w_max [i_min i_max [workers [samples]]]]
+
+// The overflow counts are those of the fx_stats of the 6_3_2a
+// "fir", which are compiled in here.
+
+#ifndef FX_STATS
+#define FX_STATS
+#endif
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+#include <math.h>
+#include <errno.h>
+#include <limits.h>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include "../6_3_2a/fir_elab_time.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+// module "fir_ref": double-precision reference for "fir"
+
+class fir_ref : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<double> in;
+    sc_out<double> out;
+
+    SC_HAS_PROCESS(fir_ref);
+
+    fir_ref(sc_module_name name, const double* coeffs, unsigned n) :
+        sc_module(name), _coeffs(coeffs), _n(n)
+    {
+        assert(n > 0);
+        SC_METHOD(main);
+        sensitive << clock.pos();
+
+        _delay_line = new double[_n];
+        for (unsigned j=0; j < _n; j++)
+            _delay_line[j] = 0;
+    }
+
+    ~fir_ref() { delete[] _delay_line; }
+
+private:
+    double *_delay_line;
+    const double* _coeffs;
+    const unsigned _n;
+
+    void main() {
+        for (int j=_n-1; j > 0; j--)
+            _delay_line[j] = _delay_line[j-1];
+
+        _delay_line[0] = in.read();
+
+        double sum = 0;
+        for (unsigned i=0; i < _n; i++)
+            sum += _delay_line[i] * _coeffs[i];
+
+        out.write(sum);
+    }
+};
+
+// pseudo-random stimulus generator
+//   Writes "samples" values uniformly distributed in
+//   [-amplitude, amplitude), one per ns. Uses its own linear
+//   congruential generator so that every worker process sees
+//   exactly the same sequence.
+
+class random_stimulus : public sc_module {
+public:
+    sc_out<double> out;
+
+    SC_HAS_PROCESS(random_stimulus);
+
+    random_stimulus(sc_module_name name, unsigned samples,
+                    double amplitude) :
+        sc_module(name), _samples(samples), _amplitude(amplitude)
+    {
+        SC_THREAD(main);
+    }
+
+private:
+    const unsigned _samples;
+    const double _amplitude;
+
+    void main() {
+        unsigned long seed = 12345;
+
+        for (unsigned k=0; k < _samples; k++) {
+            seed = (seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+            out.write(_amplitude * (2.0 * seed / 2147483648.0 - 1.0));
+            wait(1, SC_NS);
+        }
+        out.write(0);
+    }
+};
+
+// fir_probe: compares a "fir" output against the reference
+//   output. Both are written on the rising clock edge, so they
+//   are sampled on the falling edge.
+
+class fir_probe : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_in<double> ref;
+    sc_in<double> dut;
+
+    SC_HAS_PROCESS(fir_probe);
+
+    fir_probe(sc_module_name name) : sc_module(name),
+        _signal_power(0), _error_power(0), _max_error(0)
+    {
+        SC_METHOD(main);
+        sensitive << clock.neg();
+    }
+
+    double signal_power() const { return _signal_power; }
+    double error_power() const { return _error_power; }
+    double max_error() const { return _max_error; }
+
+private:
+    double _signal_power, _error_power, _max_error;
+
+    void main() {
+        double r = ref.read();
+        double e = dut.read() - r;
+
+        _signal_power += r * r;
+        _error_power += e * e;
+        if (fabs(e) > _max_error)
+            _max_error = fabs(e);
+    }
+};
+
+// one point of the design space and its measured quality
+
+struct explore_point {
+    int w, i;
+};
+
+struct explore_result {
+    int w, i;
+    double signal_power, error_power, max_error;
+    unsigned long overflows;
+
+    double snr() const {
+        if (error_power == 0)
+            return HUGE_VAL;
+        return 10 * log10(signal_power / error_power);
+    }
+};
+
+static bool by_width(const explore_result& a, const explore_result& b)
+{
+    if (a.w != b.w)
+        return a.w < b.w;
+    return a.i < b.i;
+}
+
+static const double coeffs[] = {1.1111, 2.2222, 3.3333, 4.4444};
+static const int taps = sizeof(coeffs) / sizeof(coeffs[0]);
+
+// run_slice: elaborates one "fir" per point plus a single
+//   stimulus and reference shared by all of them, simulates
+//   "samples" clock cycles and collects the probe readings.
+
+static void run_slice(const std::vector<explore_point>& points,
+                      unsigned samples,
+                      std::vector<explore_result>& results)
+{
+    unsigned k;
+
+    sc_clock clock("c1", 1, SC_NS);
+    sc_signal<double> fir_in;
+    sc_signal<double> ref_out;
+
+    random_stimulus stim1("stim1", samples, 1.0);
+    stim1.out(fir_in);
+
+    fir_ref ref1("ref1", &coeffs[0], taps);
+    ref1.clock(clock);
+    ref1.in(fir_in);
+    ref1.out(ref_out);
+
+    std::vector<fir*> firs;
+    std::vector<sc_signal<double>*> outs;
+    std::vector<fir_probe*> probes;
+
+    for (k=0; k < points.size(); k++) {
+        std::ostringstream fir_name, probe_name;
+        fir_name << "fir_w" << points[k].w << "_i" << points[k].i;
+        probe_name << "probe_w" << points[k].w << "_i" << points[k].i;
+
+        fir* firp = new fir(fir_name.str().c_str(), &coeffs[0],
+                            points[k].w, points[k].i, taps);
+        sc_signal<double>* sigp = new sc_signal<double>;
+        firp->clock(clock);
+        firp->in(fir_in);
+        firp->out(*sigp);
+
+        fir_probe* probep = new fir_probe(probe_name.str().c_str());
+        probep->clock(clock);
+        probep->ref(ref_out);
+        probep->dut(*sigp);
+
+        firs.push_back(firp);
+        outs.push_back(sigp);
+        probes.push_back(probep);
+    }
+
+    sc_start(samples, SC_NS);
+
+    for (k=0; k < points.size(); k++) {
+        explore_result r;
+        r.w = points[k].w;
+        r.i = points[k].i;
+        r.signal_power = probes[k]->signal_power();
+        r.error_power = probes[k]->error_power();
+        r.max_error = probes[k]->max_error();
+        r.overflows = firs[k]->overflows();
+        results.push_back(r);
+    }
+
+    for (k=0; k < points.size(); k++) {
+        delete probes[k];
+        delete firs[k];
+        delete outs[k];
+    }
+}
+
+// parse_int: converts all of "s" to an int; false if "s" is not
+//   a decimal number or out of range
+
+static bool parse_int(const char* s, int& v)
+{
+    char* end;
+    errno = 0;
+    long l = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || errno == ERANGE
+        || l < INT_MIN || l > INT_MAX)
+        return false;
+    v = (int) l;
+    return true;
+}
+
+static int number_of_cpus()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0)
+        return n;
+#endif
+    return 1;
+}
+
+int sc_main (int argc , char *argv[])
+{
+    int w_min = 4, w_max = 16; // range of total widths
+    int i_min = 1, i_max = 8;  // range of integer bits
+    int workers = number_of_cpus();
+    int samples = 10000;
+
+    int* const args[] = { &w_min, &w_max, &i_min, &i_max, &workers, &samples };
+    const int nargs = sizeof(args) / sizeof(args[0]);
+
+    if (argc - 1 > nargs || argc == 2 || argc == 4) {
+        cout << "usage: " << argv[0]
+             << " [w_min w_max [i_min i_max [workers [samples]]]]" << endl;
+        return 1;
+    }
+    for (int a=1; a < argc; a++) {
+        if (!parse_int(argv[a], *args[a - 1])) {
+            cout << "not a number: " << argv[a] << endl;
+            return 1;
+        }
+    }
+
+    if (w_min < 1) w_min = 1;
+    if (workers < 1) workers = 1;
+    if (samples < 1) samples = 1;
+
+    std::vector<explore_point> points;
+    for (int w=w_min; w <= w_max; w++) {
+        for (int i=i_min; i <= i_max && i <= w; i++) {
+            explore_point p;
+            p.w = w;
+            p.i = i;
+            points.push_back(p);
+        }
+    }
+
+    if (points.empty()) {
+        cout << "empty design space" << endl;
+        return 1;
+    }
+
+    std::vector<explore_result> results;
+
+#ifdef _WIN32
+    // no fork() here: simulate the whole design space in-process
+    run_slice(points, samples, results);
+#else
+    // The simulation kernel is a per-process singleton, so the
+    // design space is split across worker processes rather than
+    // threads. Each worker gets every "workers"-th point.
+
+    if (workers > (int) points.size())
+        workers = points.size();
+
+    std::vector<FILE*> pipes;
+    std::vector<pid_t> pids;
+
+    for (int k=0; k < workers; k++) {
+        std::vector<explore_point> slice;
+        for (unsigned p=k; p < points.size(); p += workers)
+            slice.push_back(points[p]);
+
+        int fd[2];
+        if (pipe(fd) != 0) {
+            perror("pipe");
+            return 1;
+        }
+
+        cout.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+
+        if (pid == 0) {
+            // worker: simulate the slice and write one line per point
+            close(fd[0]);
+            FILE* f = fdopen(fd[1], "w");
+            std::vector<explore_result> r;
+            run_slice(slice, samples, r);
+            for (unsigned j=0; j < r.size(); j++)
+                fprintf(f, "%d %d %.17g %.17g %.17g %lu\n", r[j].w, r[j].i,
+                        r[j].signal_power, r[j].error_power,
+                        r[j].max_error, r[j].overflows);
+            fclose(f);
+            _exit(0);
+        }
+
+        close(fd[1]);
+        pipes.push_back(fdopen(fd[0], "r"));
+        pids.push_back(pid);
+    }
+
+    for (unsigned k=0; k < pipes.size(); k++) {
+        explore_result r;
+        while (fscanf(pipes[k], "%d %d %lg %lg %lg %lu", &r.w, &r.i,
+                      &r.signal_power, &r.error_power,
+                      &r.max_error, &r.overflows) == 6)
+            results.push_back(r);
+        fclose(pipes[k]);
+        waitpid(pids[k], 0, 0);
+    }
+
+    if (results.size() != points.size()) {
+        cout << "lost results from worker processes" << endl;
+        return 1;
+    }
+#endif
+
+    std::sort(results.begin(), results.end(), by_width);
+
+    cout << setw(4) << "w" << setw(4) << "i" << setw(12) << "SNR [dB]"
+         << setw(14) << "max error" << setw(12) << "overflows" << endl;
+
+    for (unsigned k=0; k < results.size(); k++) {
+        const explore_result& r = results[k];
+        cout << setw(4) << r.w << setw(4) << r.i << setw(12)
+             << setprecision(4) << r.snr() << setw(14) << r.max_error
+             << setw(12) << r.overflows << endl;
+    }
+
+    // Pareto front over (w, SNR): a point is kept if no narrower
+    // configuration reaches the same or a better SNR. Within one
+    // width only the best integer split is a candidate.
+
+    cout << endl << "Pareto front (w, i):" << endl;
+
+    double best_snr = -HUGE_VAL;
+    for (unsigned k=0; k < results.size(); ) {
+        unsigned best = k;
+        unsigned j;
+        for (j=k; j < results.size() && results[j].w == results[k].w; j++)
+            if (results[j].snr() > results[best].snr())
+                best = j;
+
+        if (results[best].snr() > best_snr) {
+            best_snr = results[best].snr();
+            cout << "  w=" << results[best].w << " i=" << results[best].i
+                 << " SNR=" << setprecision(4) << best_snr << " dB" << endl;
+        }
+        k = j;
+    }
+
+    return 0;
+}
@@ -29,102 +29,293 @@
 
 #define SC_INCLUDE_FX
 #include <systemc.h>
+#include <vector>
+#include "fir_sim_time.h"
 
-template <class T, int N> class fir : public sc_module {
+// stimulus: impulses at 10, 20, 29 and 49 ns, so that the
+// coefficient reloads (see "reload") happen while an impulse
+// response is in progress
+
+template <class T> class stimulus : public sc_module {
 public:
-  sc_in<bool> clock;
-  sc_in<T> in;
   sc_out<T> out;
 
-  SC_HAS_PROCESS(fir);
+  SC_HAS_PROCESS(stimulus);
+
+  stimulus(sc_module_name name) : sc_module(name) {
+    SC_THREAD(main);
+  }
+
+  void main() {
+    out.write(0);
+    wait(10, SC_NS);
+    out.write(2);
+    wait(1, SC_NS);
+    out.write(0);
+    wait(9, SC_NS);
+    out.write(2);
+    wait(1, SC_NS);
+    out.write(0);
+    wait(8, SC_NS);
+    out.write(2);
+    wait(1, SC_NS);
+    out.write(0);
+    wait(19, SC_NS);
+    out.write(2);
+    wait(1, SC_NS);
+    out.write(0);
+  }
+};
+
+// reload: changes the coefficients of two filters F1 and F2 at
+//   rising edges, in the same delta cycle as the filters run:
+//     load_edge    - bank 1 is loaded with "coefs1" and selected
+//     set_edge     - every tap is rewritten with set_coef() from
+//                    "coefs2"; bank 0 is the free shadow bank
+//     preload_edge - bank 1 is loaded with "coefs3" but not
+//                    selected. With two banks none is free then,
+//                    so set_coef() from "coefs2" must be rejected
+//                    and leave the preloaded bank alone
+//     select_edge  - bank 1 is selected
+//   Every change takes effect at the following activation of the
+//   filters. errors() counts set_coef() calls that were accepted
+//   or rejected wrongly.
+
+template <class T, int N, class F1, class F2> class reload : public sc_module {
+public:
+  sc_in<bool> clock;
 
-  fir(sc_module_name name) : sc_module(name) {
+  SC_HAS_PROCESS(reload);
+
+  reload(sc_module_name name, F1& f1, F2& f2,
+         unsigned load_edge, const T* coefs1,
+         unsigned set_edge, const T* coefs2,
+         unsigned preload_edge, const T* coefs3, unsigned select_edge)
+    : sc_module(name), _f1(f1), _f2(f2), _edge(0), _errors(0),
+      _load_edge(load_edge), _coefs1(coefs1),
+      _set_edge(set_edge), _coefs2(coefs2),
+      _preload_edge(preload_edge), _coefs3(coefs3),
+      _select_edge(select_edge)
+  {
+    // no dont_initialize(): activations are counted like
+    // those of the filters
     SC_METHOD(main);
     sensitive << clock.pos();
+  }
+
+  unsigned errors() const { return _errors; }
+
+private:
+  F1& _f1;
+  F2& _f2;
+  unsigned _edge;
+  unsigned _errors;
+  unsigned _load_edge;
+  const T* _coefs1;
+  unsigned _set_edge;
+  const T* _coefs2;
+  unsigned _preload_edge;
+  const T* _coefs3;
+  unsigned _select_edge;
+
+  void set_all(const T* coefs, bool accepted) {
+    unsigned wrong = 0;
+    for (int i=0; i < N; i++) {
+      if (_f1.set_coef(i, coefs[i]) != accepted)
+        wrong++;
+      if (_f2.set_coef(i, coefs[i]) != accepted)
+        wrong++;
+    }
+    _errors += wrong;
+    if (wrong)
+      cout << "at time: " << sc_time_stamp() << " set_coef() "
+           << (accepted ? "rejected" : "accepted") << endl;
+  }
+
+  void main() {
+    if (_edge == _load_edge) {
+      _f1.load_bank(1, _coefs1, N);
+      _f2.load_bank(1, _coefs1, N);
+      _f1.select_bank(1);
+      _f2.select_bank(1);
+    }
+    if (_edge == _set_edge)
+      set_all(_coefs2, true);
+    if (_edge == _preload_edge) {
+      _f1.load_bank(1, _coefs3, N);
+      _f2.load_bank(1, _coefs3, N);
+      set_all(_coefs2, false);
+    }
+    if (_edge == _select_edge) {
+      _f1.select_bank(1);
+      _f2.select_bank(1);
+    }
+    _edge++;
+  }
+};
+
+// bank_check: a reference model of "fir" that is told from which
+//   activation on which coefficients are in use. It samples the
+//   input at the rising edge, like the filter, and compares the
+//   filter output at the falling edge, so any output that mixes
+//   two coefficient sets or switches at the wrong edge is reported.
+
+template <class T, int N> class bank_check : public sc_module {
+public:
+  sc_in<bool> clock;
+  sc_in<T> in;
+  sc_in<T> out;
+
+  SC_HAS_PROCESS(bank_check);
+
+  bank_check(sc_module_name name) : sc_module(name), _edge(0), _errors(0) {
+    SC_METHOD(sample);
+    sensitive << clock.pos();
+    SC_METHOD(check);
+    sensitive << clock.neg();
+    dont_initialize();
 
     for (int i=0; i < N; i++)
-      _delay_line[i] = _coefs[i] = 0;
+      _delay_line[i] = 0;
   }
 
-  void set_coef(unsigned i, T val) {
-    if (i < N) 
-      _coefs[i] = val;
+  // from activation "edge" on the filter uses "coefs"
+  void expect(unsigned edge, const T* coefs) {
+    _from.push_back(edge);
+    for (int i=0; i < N; i++)
+      _coefs.push_back(coefs[i]);
   }
 
+  unsigned errors() const { return _errors; }
+
 private:
   T _delay_line[N];
-  T _coefs[N];
+  T _expected;
+  unsigned _edge;
+  unsigned _errors;
+  std::vector<unsigned> _from;
+  std::vector<T> _coefs;
 
-  void main() {
-    // shift samples in delay line
+  void sample() {
     for (int j=N-1; j > 0; j--)
       _delay_line[j] = _delay_line[j-1];
-
-    // read new data sample
     _delay_line[0] = in.read();
 
-    // compute fir output
+    unsigned k = 0;
+    while (k + 1 < _from.size() && _from[k + 1] <= _edge)
+      k++;
+
     T sum = 0;
     for (int i=0; i < N; i++)
-      sum += _delay_line[i] * _coefs[i];
+      sum += _delay_line[i] * _coefs[k * N + i];
+    _expected = sum;
+    _edge++;
+  }
 
-    out.write(sum);
+  void check() {
+    if (!(out.read() == _expected)) {
+      cout << "at time: " << sc_time_stamp() << " bank switch error: "
+           << out.read() << " != " << _expected << endl;
+      _errors++;
+    }
   }
 };
 
-template <class T> class stimulus : public sc_module {
+template <class T> class response : public sc_module {
 public:
-  sc_out<T> out;
+  sc_in<T> in;
 
-  SC_HAS_PROCESS(stimulus);
+  SC_HAS_PROCESS(response);
 
-  stimulus(sc_module_name name) : sc_module(name) {
-    SC_THREAD(main);
+  response(sc_module_name name) : sc_module(name) {
+    SC_METHOD(main);
+    sensitive << in;
   }
 
   void main() {
-    out.write(0);
-    wait(10, SC_NS);
-    out.write(2);
-    wait(1, SC_NS);
-    out.write(0);
+    cout << "at time: " << sc_time_stamp() << " output: " << in.read() << endl;
   }
 };
 
-template <class T> class response : public sc_module {
+// compare: reports and counts every clock cycle in which two
+//   outputs differ
+
+template <class T> class compare : public sc_module {
 public:
-  sc_in<T> in;
+  sc_in<bool> clock;
+  sc_in<T> in1, in2;
 
-  SC_HAS_PROCESS(response);
+  SC_HAS_PROCESS(compare);
 
-  response(sc_module_name name) : sc_module(name) {
+  compare(sc_module_name name) : sc_module(name), _errors(0) {
     SC_METHOD(main);
-    sensitive << in;
+    sensitive << clock.neg();
   }
 
+  unsigned errors() const { return _errors; }
+
+private:
+  unsigned _errors;
+
   void main() {
-    cout << "at time: " << sc_time_stamp() << " output: " << in.read() << endl;
+    if (!(in1.read() == in2.read())) {
+      cout << "at time: " << sc_time_stamp() << " mismatch: " << in1.read()
+           << " != " << in2.read() << endl;
+      _errors++;
+    }
   }
 };
 
 
+// Define FIR_DOUBLE to simulate with double instead of sc_fixed.
+// fir2 is the table-driven fir_lut, which only exists for sc_fixed;
+// with double it is a second "fir", so that reload1 and cmp1 work
+// unchanged.
+
 int sc_main (int argc , char *argv[]) {
+#ifdef FIR_DOUBLE
+  typedef double fir_T;
+#else
   typedef sc_fixed<8,5> fir_T;
-//  typedef double fir_T;
+#endif
   const fir_T coefs[] = {1.1111, 2.2222, 3.3333, 4.4444};
   const int taps = sizeof(coefs) / sizeof(coefs[0]);
+#ifdef FIR_DOUBLE
+  typedef fir<fir_T, taps> fir2_T;
+#else
+  typedef fir_lut<8, 5, taps> fir2_T;
+#endif
+
+  // loaded into bank 1 at activation 21, written with set_coef()
+  // at activation 30, preloaded into bank 1 at activation 40 and
+  // selected at 50
+  const fir_T coefs1[taps] = {0.5, -1.0, 1.5, -2.0};
+  const fir_T coefs2[taps] = {4.4444, 3.3333, 2.2222, 1.1111};
+  const fir_T coefs3[taps] = {-1.0, 0.25, 2.0, 0.5};
 
   sc_clock clock("c1", 1, SC_NS);
   sc_signal<fir_T> fir_in;
   sc_signal<fir_T> fir_out;
+  sc_signal<fir_T> lut_out;
 
   fir<fir_T, taps> fir1("fir1");
   fir1.clock(clock);
   fir1.in(fir_in);
   fir1.out(fir_out);
 
-  for (int j=0; j < taps; j++)
-    fir1.set_coef(j, coefs[j]);
+  fir1.load_bank(0, &coefs[0], taps);
+
+  fir2_T fir2("fir2");
+  fir2.clock(clock);
+  fir2.in(fir_in);
+  fir2.out(lut_out);
+
+  fir2.load_bank(0, &coefs[0], taps);
+
+  compare<fir_T> cmp1("cmp1");
+  cmp1.clock(clock);
+  cmp1.in1(fir_out);
+  cmp1.in2(lut_out);
 
   stimulus<fir_T> stim1("stim1");
   stim1.out(fir_in);
@@ -132,6 +323,23 @@ int sc_main (int argc , char *argv[]) {
   response<fir_T> resp1("resp1");
   resp1.in(fir_out);
 
+  reload<fir_T, taps, fir<fir_T, taps>, fir2_T>
+    reload1("reload1", fir1, fir2, 21, coefs1, 30, coefs2, 40, coefs3, 50);
+  reload1.clock(clock);
+
+  bank_check<fir_T, taps> check1("check1");
+  check1.clock(clock);
+  check1.in(fir_in);
+  check1.out(fir_out);
+  check1.expect(0, coefs);
+  check1.expect(22, coefs1);
+  check1.expect(31, coefs2);
+  check1.expect(51, coefs3);
+
   sc_start(100, SC_NS);
-  return 0;
+
+  unsigned errors = check1.errors() + reload1.errors();
+  cout << "bank switching: " << errors << " errors" << endl;
+  cout << "fir2: " << cmp1.errors() << " mismatches" << endl;
+  return errors || cmp1.errors() ? 1 : 0;
 }
@@ -0,0 +1,308 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef FIR_SIM_TIME_H
+#define FIR_SIM_TIME_H
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+
+// fir: coefficients are set at simulation time. The module
+//   holds B coefficient banks (default 2). A bank can be loaded
+//   while another one is in use, and select_bank() switches
+//   between them atomically at the next rising clock edge.
+//
+//   The bank request is latched in a signal, so a select_bank()
+//   issued by another process at a rising edge always takes
+//   effect at the following edge, whichever process runs first.
+//   Coefficients must only be written into banks that are not
+//   active and not selected for the current edge; load_bank()
+//   of the bank selected in the same delta cycle races with main.
+//
+//   A bank loaded with load_bank() is pending until it becomes
+//   active; set_coef(i, val) never uses a pending bank as its
+//   shadow copy (see there). At most 32 banks.
+
+template <class T, int N, int B = 2> class fir : public sc_module {
+public:
+  sc_in<bool> clock;
+  sc_in<T> in;
+  sc_out<T> out;
+
+  SC_HAS_PROCESS(fir);
+
+  fir(sc_module_name name)
+    : sc_module(name), _active(0), _requested(0), _pending(0) {
+    SC_METHOD(main);
+    sensitive << clock.pos();
+
+    for (int i=0; i < N; i++) {
+      _delay_line[i] = 0;
+      for (int b=0; b < B; b++)
+        _coefs[b][i] = 0;
+    }
+  }
+
+  // set one coefficient of the coefficients in use from the next
+  // rising edge on: all set_coef() calls before that edge take
+  // effect together. If another bank is already selected for it,
+  // that bank is written. Otherwise the active bank is copied to a
+  // free bank, which is then written and selected; a bank is free
+  // if it is neither active nor pending. Returns false, and writes
+  // nothing, if there is no free bank, e.g. with B == 2 after
+  // load_bank() of the other bank. With B == 1 there is no shadow
+  // bank and the active bank is written.
+  bool set_coef(unsigned i, T val) {
+    if (_requested == _active && B > 1) {
+      int shadow = free_bank();
+      if (shadow < 0)
+        return false;
+      for (int k=0; k < N; k++)
+        _coefs[shadow][k] = _coefs[_active][k];
+      select_bank(shadow);
+    }
+    set_coef(_requested, i, val);
+    return true;
+  }
+
+  void set_coef(unsigned bank, unsigned i, T val) {
+    if (bank < B && i < N) 
+      _coefs[bank][i] = val;
+  }
+
+  // load "n" coefficients into a bank in one call;
+  // remaining taps of that bank are cleared
+  void load_bank(unsigned bank, const T* coefs, unsigned n) {
+    if (bank >= B)
+      return;
+    for (unsigned i=0; i < N; i++)
+      _coefs[bank][i] = (i < n) ? coefs[i] : T(0);
+    if (bank != _active)
+      _pending |= 1u << bank;
+  }
+
+  // switch banks; takes effect at the next rising clock edge
+  void select_bank(unsigned bank) {
+    if (bank < B) {
+      _requested = bank;
+      _select.write(bank);
+    }
+  }
+
+  unsigned active_bank() const { return _active; }
+
+private:
+  // compile-time check of the template parameters: the array size
+  // is negative unless 0 < B <= 32
+  typedef char check_params[(B > 0 && B <= 32) ? 1 : -1];
+
+  T _delay_line[N];
+  T _coefs[B][N];
+  unsigned _active, _requested;
+  unsigned _pending;	// one bit per bank
+  sc_signal<unsigned> _select;
+
+  int free_bank() const {
+    for (int b=0; b < B; b++)
+      if (b != (int) _active && !((_pending >> b) & 1))
+        return b;
+    return -1;
+  }
+
+  void main() {
+    // a pending bank switch happens here and only here, so an
+    // output sample never mixes coefficients of two banks
+    _active = _select.read();
+    _pending &= ~(1u << _active);
+    const T* coefs = _coefs[_active];
+
+    // shift samples in delay line
+    for (int j=N-1; j > 0; j--)
+      _delay_line[j] = _delay_line[j-1];
+
+    // read new data sample
+    _delay_line[0] = in.read();
+
+    // compute fir output
+    T sum = 0;
+    for (int i=0; i < N; i++)
+      sum += _delay_line[i] * coefs[i];
+
+    out.write(sum);
+  }
+};
+
+// fir_lut: table-driven version of fir<sc_fixed<W,I>, N, B>.
+//   With W-bit samples there are only 2^W possible input values
+//   per tap, so for every coefficient a table of the quantized
+//   products of all 2^W inputs is built when the coefficient is
+//   set. Each tap then costs one table lookup and one integer
+//   add, and the delay line holds raw W-bit values.
+//
+//   The results are bit-exact with the sc_fixed loop of "fir" for
+//   the default SC_TRN quantization and SC_WRAP overflow modes:
+//   "sum" is always on the W-bit grid, so quantizing sum+product
+//   equals sum plus the quantized product, and wrap-around is
+//   addition modulo 2^W. W should be small (the tables hold
+//   B * N * 2^W ints).
+
+template <int W, int I, int N, int B = 2> class fir_lut : public sc_module {
+public:
+  typedef sc_fixed<W,I> T;
+
+  sc_in<bool> clock;
+  sc_in<T> in;
+  sc_out<T> out;
+
+  SC_HAS_PROCESS(fir_lut);
+
+  fir_lut(sc_module_name name)
+    : sc_module(name), _active(0), _requested(0), _pending(0) {
+    SC_METHOD(main);
+    sensitive << clock.pos();
+
+    _table = new unsigned[B * N * SIZE];
+    for (int i=0; i < N; i++) {
+      _delay_line[i] = 0;
+      for (int b=0; b < B; b++)
+        set_coef(b, i, 0);
+    }
+  }
+
+  ~fir_lut() { delete[] _table; }
+
+  // as fir::set_coef(), the tables are copied along
+  bool set_coef(unsigned i, T val) {
+    if (_requested == _active && B > 1) {
+      int shadow = free_bank();
+      if (shadow < 0)
+        return false;
+      for (int k=0; k < N; k++)
+        _coefs[shadow][k] = _coefs[_active][k];
+      const unsigned* from = table(_active, 0);
+      unsigned* to = table(shadow, 0);
+      for (unsigned k=0; k < N * SIZE; k++)
+        to[k] = from[k];
+      select_bank(shadow);
+    }
+    set_coef(_requested, i, val);
+    return true;
+  }
+
+  void set_coef(unsigned bank, unsigned i, T val) {
+    if (bank < B && i < N) {
+      _coefs[bank][i] = val;
+      build_table(bank, i);
+    }
+  }
+
+  void load_bank(unsigned bank, const T* coefs, unsigned n) {
+    if (bank >= B)
+      return;
+    for (unsigned i=0; i < N; i++)
+      set_coef(bank, i, (i < n) ? coefs[i] : T(0));
+    if (bank != _active)
+      _pending |= 1u << bank;
+  }
+
+  void select_bank(unsigned bank) {
+    if (bank < B) {
+      _requested = bank;
+      _select.write(bank);
+    }
+  }
+
+  unsigned active_bank() const { return _active; }
+
+private:
+  // as in fir, and W <= 16 and I <= W
+  typedef char check_params[(B > 0 && B <= 32 && W <= 16 && I <= W) ? 1 : -1];
+
+  enum { F = W - I, SIZE = 1 << W, MASK = SIZE - 1 };
+
+  unsigned _delay_line[N]; // raw W-bit samples
+  T _coefs[B][N];
+  unsigned* _table;        // [B][N][SIZE] quantized products
+  unsigned _active, _requested;
+  unsigned _pending;       // one bit per bank
+  sc_signal<unsigned> _select;
+
+  int free_bank() const {
+    for (int b=0; b < B; b++)
+      if (b != (int) _active && !((_pending >> b) & 1))
+        return b;
+    return -1;
+  }
+
+  // conversions between T and its raw W-bit two's complement pattern
+  static unsigned to_raw(const T& v) {
+    return (unsigned) (int) (v.to_double() * (1 << F)) & MASK;
+  }
+
+  static T from_raw(unsigned raw) {
+    int r = raw & MASK;
+    if (r & (SIZE >> 1))
+      r -= SIZE;
+    return T(double(r) / (1 << F));
+  }
+
+  unsigned* table(unsigned bank, unsigned i) {
+    return &_table[(bank * N + i) * SIZE];
+  }
+
+  // the table entries are computed with sc_fixed itself, exactly
+  // like one step of the accumulation in fir::main
+  void build_table(unsigned bank, unsigned i) {
+    unsigned* t = table(bank, i);
+    for (unsigned r=0; r < SIZE; r++) {
+      T p = 0;
+      p += from_raw(r) * _coefs[bank][i];
+      t[r] = to_raw(p);
+    }
+  }
+
+  void main() {
+    _active = _select.read();
+    _pending &= ~(1u << _active);
+
+    // shift samples in delay line
+    for (int j=N-1; j > 0; j--)
+      _delay_line[j] = _delay_line[j-1];
+
+    // read new data sample
+    _delay_line[0] = to_raw(in.read());
+
+    // compute fir output; wrap-around happens in from_raw()
+    const unsigned* t = table(_active, 0);
+    unsigned sum = 0;
+    for (int i=0; i < N; i++, t += SIZE)
+      sum += t[_delay_line[i]];
+
+    out.write(from_raw(sum));
+  }
+};
+
+#endif
@@ -0,0 +1,228 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+#ifndef FX_VECTOR_H
+#define FX_VECTOR_H
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+
+// class template "fx_vector"
+//   A packed vector of L fixed-point values that all have the
+//   format of sc_fixed<W, I, Q, O>. Each lane is stored as a raw
+//   two's complement integer of 8, 16 or 32 bits, and every
+//   operation is a plain loop over the lanes with the quantization
+//   and overflow modes resolved at compile time, so the compiler
+//   can turn it into SIMD instructions.
+//
+//   Lane k of a + b, a - b, a * b and mac() is bit-exact with the
+//   corresponding sc_fixed<W, I, Q, O> expression:
+//     c = a + b;  c = a - b;  c = a * b;  sum += a * b;
+//
+// Template Parameters:
+//   int W, int I - total and integer bits, 1 <= W <= 31, 0 <= I <= W
+//   sc_q_mode Q - any quantization mode
+//   sc_o_mode O - SC_WRAP, SC_SAT, SC_SAT_ZERO or SC_SAT_SYM
+//     (SC_WRAP_SM and n_bits other than 0 are not supported)
+//   int L - number of lanes
+
+#ifdef _MSC_VER
+typedef __int64 fx_int64;
+#else
+typedef long long fx_int64;
+#endif
+
+// fx_lane: smallest lane type holding W bits, and an intermediate
+// type wide enough for "sum << F" plus a full product
+
+template <bool B8, bool B16> struct fx_lane_select {
+    typedef int lane_type;
+    typedef fx_int64 wide_type;
+};
+
+template <> struct fx_lane_select<false, true> {
+    typedef short lane_type;
+    typedef fx_int64 wide_type;
+};
+
+template <> struct fx_lane_select<true, true> {
+    typedef signed char lane_type;
+    typedef int wide_type;
+};
+
+template <int W> struct fx_lane : fx_lane_select<(W <= 8), (W <= 16)> {};
+
+template <int W, int I, sc_q_mode Q = SC_TRN, sc_o_mode O = SC_WRAP,
+          int L = 16>
+class fx_vector {
+public:
+    typedef sc_fixed<W, I, Q, O> value_type;
+    typedef typename fx_lane<W>::lane_type lane_type;
+    typedef typename fx_lane<W>::wide_type wide_type;
+
+    enum { lanes = L, frac_bits = W - I };
+
+    fx_vector() {
+        for (int k=0; k < L; k++)
+            _lane[k] = 0;
+    }
+
+    explicit fx_vector(const value_type& v) {
+        lane_type r = to_raw(v);
+        for (int k=0; k < L; k++)
+            _lane[k] = r;
+    }
+
+    value_type get(int k) const { return from_raw(_lane[k]); }
+    void set(int k, const value_type& v) { _lane[k] = to_raw(v); }
+
+    lane_type raw(int k) const { return _lane[k]; }
+    void set_raw(int k, lane_type r) { _lane[k] = r; }
+
+    fx_vector& operator+=(const fx_vector& b) {
+        for (int k=0; k < L; k++)
+            _lane[k] = overflow(wide_type(_lane[k]) + b._lane[k]);
+        return *this;
+    }
+
+    fx_vector& operator-=(const fx_vector& b) {
+        for (int k=0; k < L; k++)
+            _lane[k] = overflow(wide_type(_lane[k]) - b._lane[k]);
+        return *this;
+    }
+
+    fx_vector& operator*=(const fx_vector& b) {
+        for (int k=0; k < L; k++)
+            _lane[k] = overflow(quantize(wide_type(_lane[k]) * b._lane[k]));
+        return *this;
+    }
+
+    // multiply-accumulate: the exact product is added to the sum
+    // before quantization, as in "sum += a * b" with sc_fixed
+    fx_vector& mac(const fx_vector& a, const fx_vector& b) {
+        for (int k=0; k < L; k++)
+            _lane[k] = overflow(quantize(
+                wide_type(_lane[k]) * one() +
+                wide_type(a._lane[k]) * b._lane[k]));
+        return *this;
+    }
+
+    // multiply-accumulate with the same factor in every lane
+    fx_vector& mac(const fx_vector& a, const value_type& b) {
+        wide_type rb = to_raw(b);
+        for (int k=0; k < L; k++)
+            _lane[k] = overflow(quantize(
+                wide_type(_lane[k]) * one() + a._lane[k] * rb));
+        return *this;
+    }
+
+    friend fx_vector operator+(fx_vector a, const fx_vector& b) { return a += b; }
+    friend fx_vector operator-(fx_vector a, const fx_vector& b) { return a -= b; }
+    friend fx_vector operator*(fx_vector a, const fx_vector& b) { return a *= b; }
+
+    bool operator==(const fx_vector& b) const {
+        for (int k=0; k < L; k++)
+            if (_lane[k] != b._lane[k])
+                return false;
+        return true;
+    }
+
+private:
+    // compile-time check of the template parameters, for every
+    // constructor: the array size is negative if one is unsupported
+    typedef char check_params[(W >= 1 && W <= 31 && I >= 0 && I <= W &&
+                               O != SC_WRAP_SM && L > 0) ? 1 : -1];
+
+    lane_type _lane[L];
+
+    // raw value of 1.0
+    static wide_type one() { return wide_type(1) << frac_bits; }
+
+    static lane_type to_raw(const value_type& v) {
+        // v is on the grid, so this is exact
+        return lane_type(fx_int64(v.to_double() * one()));
+    }
+
+    static value_type from_raw(lane_type r) {
+        return value_type(double(r) / one());
+    }
+
+    // removes frac_bits fractional bits according to Q
+    static wide_type quantize(wide_type x) {
+        if (frac_bits == 0)
+            return x;
+
+        const wide_type half = one() / 2;
+        wide_type q = x >> frac_bits;          // floor
+        wide_type rem = x - q * one();         // 0 <= rem < one()
+        bool up;
+
+        switch (Q) {
+        case SC_RND:         up = rem >= half; break;
+        case SC_RND_ZERO:    up = rem > half || (rem == half && x < 0); break;
+        case SC_RND_MIN_INF: up = rem > half; break;
+        case SC_RND_INF:     up = rem > half || (rem == half && x >= 0); break;
+        case SC_RND_CONV:    up = rem > half || (rem == half && (q & 1)); break;
+        case SC_TRN_ZERO:    up = rem != 0 && x < 0; break;
+        default:             up = false; break; // SC_TRN
+        }
+        return q + up;
+    }
+
+    // brings x into the W-bit range according to O
+    static lane_type overflow(wide_type x) {
+        const wide_type max = (wide_type(1) << (W-1)) - 1;
+        const wide_type min = -max - 1;
+
+        switch (O) {
+        case SC_SAT:
+            return lane_type(x > max ? max : (x < min ? min : x));
+        case SC_SAT_ZERO:
+            return lane_type(x > max || x < min ? 0 : x);
+        case SC_SAT_SYM:
+            return lane_type(x > max ? max : (x < min ? -max : x));
+        default: // SC_WRAP
+            {
+                wide_type m = (wide_type(1) << W) - 1;
+                wide_type r = x & m;
+                return lane_type(r > max ? r - m - 1 : r);
+            }
+        }
+    }
+};
+
+template <int W, int I, sc_q_mode Q, sc_o_mode O, int L>
+inline ostream& operator<<(ostream& os, const fx_vector<W, I, Q, O, L>& v)
+{
+    os << "(";
+    for (int k=0; k < L; k++)
+        os << (k ? " " : "") << v.get(k);
+    return os << ")";
+}
+
+#endif
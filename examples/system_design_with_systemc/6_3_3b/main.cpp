@@ -0,0 +1,178 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+// Checks fx_vector lane by lane against sc_fixed for several
+// formats and modes, then compares the speed of an N-tap FIR over
+// L channels computed with sc_fixed and with fx_vector.
+
+#include "fx_vector.h"
+#include <time.h>
+#include <vector>
+
+// random value on the grid of sc_fixed<W, I>
+template <int W, int I>
+static double random_value()
+{
+    int r = (rand() % (1 << W)) - (1 << (W-1));
+    return double(r) / (1 << (W-I));
+}
+
+// returns the number of mismatching lane operations
+template <int W, int I, sc_q_mode Q, sc_o_mode O>
+static unsigned check(const char* what, unsigned trials)
+{
+    typedef sc_fixed<W, I, Q, O> T;
+    typedef fx_vector<W, I, Q, O> vec_T;
+    const int L = vec_T::lanes;
+    const int ops = 4;          // +, -, * and mac() per lane
+    unsigned errors = 0;
+
+    for (unsigned t=0; t < trials; t++) {
+        vec_T a, b, s;
+        T as[L], bs[L], ss[L];
+
+        for (int k=0; k < L; k++) {
+            as[k] = random_value<W, I>();
+            bs[k] = random_value<W, I>();
+            ss[k] = random_value<W, I>();
+            a.set(k, as[k]);
+            b.set(k, bs[k]);
+            s.set(k, ss[k]);
+        }
+
+        vec_T sum = a + b;
+        vec_T diff = a - b;
+        vec_T prod = a * b;
+        s.mac(a, b);
+
+        for (int k=0; k < L; k++) {
+            T c;
+            c = as[k] + bs[k];
+            if (c != sum.get(k)) errors++;
+            c = as[k] - bs[k];
+            if (c != diff.get(k)) errors++;
+            c = as[k] * bs[k];
+            if (c != prod.get(k)) errors++;
+            ss[k] += as[k] * bs[k];
+            if (ss[k] != s.get(k)) errors++;
+        }
+    }
+
+    cout << what << ": " << errors << " mismatches in "
+         << trials * L * ops << " lane operations" << endl;
+    return errors;
+}
+
+int sc_main (int argc , char *argv[])
+{
+    unsigned samples = 20000;
+
+    if (argc > 1) samples = atoi(argv[1]);
+
+    unsigned lane_errors = 0;
+    lane_errors += check<8, 5, SC_TRN, SC_WRAP>("sc_fixed<8,5>", 1000);
+    lane_errors += check<8, 3, SC_RND, SC_SAT>
+        ("sc_fixed<8,3,SC_RND,SC_SAT>", 1000);
+    lane_errors += check<12, 6, SC_RND_ZERO, SC_SAT_ZERO>
+        ("sc_fixed<12,6,SC_RND_ZERO,SC_SAT_ZERO>", 1000);
+    lane_errors += check<16, 4, SC_RND_CONV, SC_SAT_SYM>
+        ("sc_fixed<16,4,SC_RND_CONV,SC_SAT_SYM>", 1000);
+    lane_errors += check<24, 8, SC_TRN_ZERO, SC_WRAP>
+        ("sc_fixed<24,8,SC_TRN_ZERO>", 1000);
+
+    // FIR over L channels: sc_fixed loop vs. fx_vector. Both
+    // see the same pseudo-random input; outputs are kept as
+    // doubles (exact for this format) and compared afterwards.
+
+    typedef sc_fixed<8,5> fir_T;
+    typedef fx_vector<8, 5, SC_TRN, SC_WRAP, 32> vec_T;
+    const fir_T coefs[] = {1.1111, 2.2222, 3.3333, 4.4444};
+    const int taps = sizeof(coefs) / sizeof(coefs[0]);
+    const int L = vec_T::lanes;
+    int j, k;
+    unsigned n;
+
+    std::vector<double> input(samples * L);
+    unsigned long seed = 12345;
+    for (n=0; n < samples * L; n++) {
+        seed = (seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+        input[n] = double(seed % 256) / 8 - 16;
+    }
+
+    std::vector<double> ref_out(samples * L), vec_out(samples * L);
+
+    fir_T delay_line[taps][L];
+    for (j=0; j < taps; j++)
+        for (k=0; k < L; k++)
+            delay_line[j][k] = 0;
+
+    clock_t t0 = clock();
+    for (n=0; n < samples; n++) {
+        for (j=taps-1; j > 0; j--)
+            for (k=0; k < L; k++)
+                delay_line[j][k] = delay_line[j-1][k];
+        for (k=0; k < L; k++)
+            delay_line[0][k] = input[n * L + k];
+
+        for (k=0; k < L; k++) {
+            fir_T sum = 0;
+            for (j=0; j < taps; j++)
+                sum += delay_line[j][k] * coefs[j];
+            ref_out[n * L + k] = sum.to_double();
+        }
+    }
+
+    clock_t t1 = clock();
+    vec_T vdelay_line[taps];
+    for (n=0; n < samples; n++) {
+        for (j=taps-1; j > 0; j--)
+            vdelay_line[j] = vdelay_line[j-1];
+        for (k=0; k < L; k++)
+            vdelay_line[0].set(k, input[n * L + k]);
+
+        vec_T sum;
+        for (j=0; j < taps; j++)
+            sum.mac(vdelay_line[j], coefs[j]);
+        for (k=0; k < L; k++)
+            vec_out[n * L + k] = sum.get(k).to_double();
+    }
+    clock_t t2 = clock();
+
+    unsigned errors = 0;
+    for (n=0; n < samples * L; n++)
+        if (ref_out[n] != vec_out[n])
+            errors++;
+
+    cout << endl << taps << "-tap FIR, " << L << " channels, " << samples
+         << " samples: " << errors << " mismatches" << endl;
+    cout << "  sc_fixed:  " << double(t1 - t0) / CLOCKS_PER_SEC << " s" << endl;
+    cout << "  fx_vector: " << double(t2 - t1) / CLOCKS_PER_SEC << " s"
+         << " (including conversions at the boundaries)" << endl;
+
+    return lane_errors || errors ? 1 : 0;
+}
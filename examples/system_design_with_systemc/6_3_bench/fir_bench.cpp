@@ -0,0 +1,428 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+// Benchmark for the three FIR parameterization styles of section 6.3:
+//
+//   ct - compile-time: fir<T,N> with const coefficients (6_3_1)
+//   et - elaboration-time: runtime-sized sc_fix fir (6_3_2a)
+//   st - simulation-time: fir<T,N> with set_coef/load_bank (6_3_3)
+//
+// Each run elaborates a number of identical FIR instances fed by
+// one pseudo-random source that changes on every clock edge, and
+// measures CPU time per processed sample and heap bytes allocated
+// per FIR instance.
+//
+// Usage:
+//   run.x                               full matrix (one process per run)
+//   run.x style type taps cycles [instances]
+//     style: ct | et | st
+//     type:  double | fixed (sc_fixed<8,5>) | fix (sc_fix, w=8, i=5)
+//     taps:  4 | 16 | 64
+//
+// Not every style runs with every type: "et" computes in sc_fix
+// internally and has a double interface, so it only runs as "fix".
+// "ct" and "st" only run as "double" and "fixed": they declare
+// their variables as T, and an sc_fix declared without a word
+// length gets the default context (32 bits) instead of w=8, i=5.
+// The report lists these combinations as not run.
+//
+// The modules are the ones of the examples, included from their
+// headers. All three are called "fir", so each header is included
+// in a namespace of its own; everything they include is included
+// first, at file scope, so that their own includes are no-ops.
+
+#define SC_INCLUDE_FX
+#include <systemc.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "../6_3_2b/alloc_count.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+// compile-time style, see 6_3_1
+namespace ct {
+#include "../6_3_1/fir_compile_time.h"
+}
+
+// elaboration-time style, see 6_3_2a
+namespace et {
+#include "../6_3_2a/fir_elab_time.h"
+}
+
+// simulation-time style, see 6_3_3
+namespace st {
+#include "../6_3_3/fir_sim_time.h"
+}
+
+// count every heap allocation, so that the memory used by a module
+// (including its ports, processes and internal arrays) can be measured
+
+ALLOC_COUNT_DEFINE_OPERATOR_NEW
+
+// bench_source: writes a new pseudo-random value in [-1, 1)
+//   on every rising clock edge
+
+template <class T> class bench_source : public sc_module {
+public:
+    sc_in<bool> clock;
+    sc_out<T> out;
+
+    SC_HAS_PROCESS(bench_source);
+
+    bench_source(sc_module_name name) : sc_module(name), _seed(12345) {
+        SC_METHOD(main);
+        sensitive << clock.pos();
+    }
+
+private:
+    unsigned long _seed;
+
+    void main() {
+        _seed = (_seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+        out.write(T(2.0 * _seed / 2147483648.0 - 1.0));
+    }
+};
+
+// coefficient pattern of the book examples, repeated to N taps
+
+static void make_coeffs(double* coeffs, unsigned n)
+{
+    for (unsigned k=0; k < n; k++)
+        coeffs[k] = 1.1111 * (k % 4 + 1);
+}
+
+// build_*: elaborate the source and "instances" FIRs of one style;
+//   return the heap bytes allocated per FIR instance
+
+template <class T, unsigned N>
+static unsigned long build_ct(sc_clock& clk, unsigned instances)
+{
+    static double dcoeffs[N];
+    static T coeffs[N];
+    make_coeffs(dcoeffs, N);
+    for (unsigned k=0; k < N; k++)
+        coeffs[k] = dcoeffs[k];
+
+    sc_signal<T>* in = new sc_signal<T>;
+    bench_source<T>* src = new bench_source<T>("src");
+    src->clock(clk);
+    src->out(*in);
+
+    std::vector<sc_signal<T>*> outs;
+    for (unsigned k=0; k < instances; k++)
+        outs.push_back(new sc_signal<T>);
+
+    char buf[16];
+    unsigned long before = alloc_count_bytes();
+    for (unsigned k=0; k < instances; k++) {
+        sprintf(buf, "fir%d", k);
+        ct::fir<T, N>* firp = new ct::fir<T, N>(buf, coeffs);
+        firp->clock(clk);
+        firp->in(*in);
+        firp->out(*outs[k]);
+    }
+    return (alloc_count_bytes() - before) / instances;
+}
+
+static unsigned long build_et(sc_clock& clk, unsigned taps, unsigned instances)
+{
+    double* coeffs = new double[taps];
+    make_coeffs(coeffs, taps);
+
+    sc_signal<double>* in = new sc_signal<double>;
+    bench_source<double>* src = new bench_source<double>("src");
+    src->clock(clk);
+    src->out(*in);
+
+    std::vector<sc_signal<double>*> outs;
+    for (unsigned k=0; k < instances; k++)
+        outs.push_back(new sc_signal<double>);
+
+    char buf[16];
+    unsigned long before = alloc_count_bytes();
+    for (unsigned k=0; k < instances; k++) {
+        sprintf(buf, "fir%d", k);
+        et::fir* firp = new et::fir(buf, coeffs, 8, 5, taps);
+        firp->clock(clk);
+        firp->in(*in);
+        firp->out(*outs[k]);
+    }
+    return (alloc_count_bytes() - before) / instances;
+}
+
+template <class T, unsigned N>
+static unsigned long build_st(sc_clock& clk, unsigned instances)
+{
+    static double dcoeffs[N];
+    static T coeffs[N];
+    make_coeffs(dcoeffs, N);
+    for (unsigned k=0; k < N; k++)
+        coeffs[k] = dcoeffs[k];
+
+    sc_signal<T>* in = new sc_signal<T>;
+    bench_source<T>* src = new bench_source<T>("src");
+    src->clock(clk);
+    src->out(*in);
+
+    std::vector<sc_signal<T>*> outs;
+    for (unsigned k=0; k < instances; k++)
+        outs.push_back(new sc_signal<T>);
+
+    char buf[16];
+    unsigned long before = alloc_count_bytes();
+    for (unsigned k=0; k < instances; k++) {
+        sprintf(buf, "fir%d", k);
+        st::fir<T, N>* firp = new st::fir<T, N>(buf);
+        firp->clock(clk);
+        firp->in(*in);
+        firp->out(*outs[k]);
+        firp->load_bank(0, coeffs, N);
+    }
+    return (alloc_count_bytes() - before) / instances;
+}
+
+template <class T>
+static unsigned long build_ct(sc_clock& clk, unsigned taps, unsigned instances)
+{
+    switch (taps) {
+    case 4:  return build_ct<T, 4>(clk, instances);
+    case 16: return build_ct<T, 16>(clk, instances);
+    default: return build_ct<T, 64>(clk, instances);
+    }
+}
+
+template <class T>
+static unsigned long build_st(sc_clock& clk, unsigned taps, unsigned instances)
+{
+    switch (taps) {
+    case 4:  return build_st<T, 4>(clk, instances);
+    case 16: return build_st<T, 16>(clk, instances);
+    default: return build_st<T, 64>(clk, instances);
+    }
+}
+
+// one benchmark run
+
+struct bench_config {
+    const char* style;
+    const char* type;
+    unsigned taps;
+    unsigned cycles;
+    unsigned instances;
+};
+
+struct bench_result {
+    double seconds;
+    unsigned long bytes_per_instance;
+};
+
+static bool valid_config(const bench_config& cfg)
+{
+    if (cfg.taps != 4 && cfg.taps != 16 && cfg.taps != 64)
+        return false;
+    if (cfg.cycles == 0 || cfg.instances == 0)
+        return false;
+    if (strcmp(cfg.style, "et") == 0)
+        return strcmp(cfg.type, "fix") == 0;
+    if (strcmp(cfg.style, "ct") == 0 || strcmp(cfg.style, "st") == 0)
+        return strcmp(cfg.type, "double") == 0 || strcmp(cfg.type, "fixed") == 0;
+    return false;
+}
+
+static void run_one(const bench_config& cfg, bench_result& r)
+{
+    typedef sc_fixed<8,5> fixed_T;
+
+    sc_clock clk("c1", 1, SC_NS);
+    bool ct = strcmp(cfg.style, "ct") == 0;
+    bool st = strcmp(cfg.style, "st") == 0;
+    bool dbl = strcmp(cfg.type, "double") == 0;
+
+    if (ct && dbl)
+        r.bytes_per_instance = build_ct<double>(clk, cfg.taps, cfg.instances);
+    else if (ct)
+        r.bytes_per_instance = build_ct<fixed_T>(clk, cfg.taps, cfg.instances);
+    else if (st && dbl)
+        r.bytes_per_instance = build_st<double>(clk, cfg.taps, cfg.instances);
+    else if (st)
+        r.bytes_per_instance = build_st<fixed_T>(clk, cfg.taps, cfg.instances);
+    else
+        r.bytes_per_instance = build_et(clk, cfg.taps, cfg.instances);
+
+    // elaborate, initialize and run the first edge outside
+    // of the measured interval
+    sc_start(1, SC_NS);
+
+    clock_t t0 = clock();
+    sc_start(cfg.cycles, SC_NS);
+    r.seconds = double(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void print_header()
+{
+    cout << "style type     taps   cycles  inst     samples/s   ns/sample"
+         << "  bytes/inst" << endl;
+}
+
+static void print_result(const bench_config& cfg, const bench_result& r)
+{
+    double samples = double(cfg.cycles) * cfg.instances;
+    char buf[128];
+
+    sprintf(buf, "%-5s %-8s %4u %8u %5u %13.0f %11.1f %11lu",
+            cfg.style, cfg.type, cfg.taps, cfg.cycles, cfg.instances,
+            r.seconds > 0 ? samples / r.seconds : 0.0,
+            1e9 * r.seconds / samples, r.bytes_per_instance);
+    cout << buf << endl;
+}
+
+// lists the style/type combinations that valid_config() rejects
+
+static void print_not_run()
+{
+    static const char* const styles[] = { "ct", "et", "st" };
+    static const char* const types[] = { "double", "fixed", "fix" };
+
+    cout << "not run:";
+    for (unsigned s=0; s < 3; s++)
+        for (unsigned t=0; t < 3; t++) {
+            bench_config cfg = { styles[s], types[t], 4, 1, 1 };
+            if (!valid_config(cfg))
+                cout << " " << cfg.style << "/" << cfg.type;
+        }
+    cout << endl
+         << "  (et computes in sc_fix; ct and st would give sc_fix"
+         << " the default word length)" << endl;
+}
+
+int sc_main (int argc , char *argv[])
+{
+    bench_config cfg;
+    bench_result r;
+
+    if (argc > 4) {
+        // a single run
+        cfg.style = argv[1];
+        cfg.type = argv[2];
+        cfg.taps = atoi(argv[3]);
+        cfg.cycles = atoi(argv[4]);
+        cfg.instances = (argc > 5) ? atoi(argv[5]) : 16;
+
+        if (!valid_config(cfg)) {
+            cout << "invalid configuration" << endl;
+            return 1;
+        }
+
+        run_one(cfg, r);
+        print_header();
+        print_result(cfg, r);
+        return 0;
+    }
+
+#ifdef _WIN32
+    // no fork() here: a single default run
+    cfg.style = "ct";
+    cfg.type = "double";
+    cfg.taps = 16;
+    cfg.cycles = 10000;
+    cfg.instances = 16;
+    run_one(cfg, r);
+    print_header();
+    print_result(cfg, r);
+    print_not_run();
+#else
+    // Full matrix. Modules cannot be added once the simulation has
+    // started, so every run gets a fresh process. Runs are made one
+    // after the other so that they do not compete for the CPU.
+
+    static const char* const styles[][2] = {
+        { "ct", "double" }, { "ct", "fixed" }, { "et", "fix" },
+        { "st", "double" }, { "st", "fixed" }
+    };
+    static const unsigned taps[] = { 4, 16, 64 };
+    static const unsigned cycles[] = { 1000, 10000 };
+
+    print_header();
+
+    for (unsigned s=0; s < sizeof(styles) / sizeof(styles[0]); s++) {
+        for (unsigned t=0; t < sizeof(taps) / sizeof(taps[0]); t++) {
+            for (unsigned c=0; c < sizeof(cycles) / sizeof(cycles[0]); c++) {
+                cfg.style = styles[s][0];
+                cfg.type = styles[s][1];
+                cfg.taps = taps[t];
+                cfg.cycles = cycles[c];
+                cfg.instances = 16;
+
+                int fd[2];
+                if (pipe(fd) != 0) {
+                    perror("pipe");
+                    return 1;
+                }
+
+                cout.flush();
+                pid_t pid = fork();
+                if (pid < 0) {
+                    perror("fork");
+                    return 1;
+                }
+
+                if (pid == 0) {
+                    close(fd[0]);
+                    run_one(cfg, r);
+                    FILE* f = fdopen(fd[1], "w");
+                    fprintf(f, "%.17g %lu\n", r.seconds, r.bytes_per_instance);
+                    fclose(f);
+                    _exit(0);
+                }
+
+                close(fd[1]);
+                FILE* f = fdopen(fd[0], "r");
+                bool ok = fscanf(f, "%lg %lu", &r.seconds,
+                                 &r.bytes_per_instance) == 2;
+                fclose(f);
+                waitpid(pid, 0, 0);
+
+                if (ok)
+                    print_result(cfg, r);
+                else
+                    cout << cfg.style << " " << cfg.type << " " << cfg.taps
+                         << ": run failed" << endl;
+            }
+        }
+    }
+    print_not_run();
+#endif
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+
+
+
+#include "cache.h"
+
+static unsigned
+log2_exact(unsigned n)
+{
+  unsigned l = 0;
+  while ((1u << l) < n)
+    l++;
+  assert((1u << l) == n);
+  return l;
+}
+
+cache_model::cache_model(const cache_config& config)
+  : _config(config), _now(0)
+{
+  _config.fit();
+  assert(_config.ways >= 1 && _config.ways <= 32);
+  assert(_config.size >= _config.ways * _config.line_size);
+
+  _sets = _config.size / (_config.ways * _config.line_size);
+  _line_shift = log2_exact(_config.line_size);
+  _set_shift = log2_exact(_sets);
+  _set_mask = _sets - 1;
+  if (_config.replacement == CACHE_PLRU)
+    log2_exact(_config.ways);
+
+  _tags.resize(_sets * _config.ways);
+  _valid.resize(_sets);
+  _dirty.resize(_sets);
+  _stamp.resize(_sets * _config.ways);
+  _plru.resize(_sets);
+  invalidate();
+}
+
+void
+cache_model::invalidate()
+{
+  for (unsigned s=0; s < _sets; s++)
+    _valid[s] = _dirty[s] = _plru[s] = 0;
+  for (unsigned i=0; i < _tags.size(); i++)
+    _tags[i] = _stamp[i] = 0;
+}
+
+unsigned
+cache_model::access(uint64 addr, bool write)
+{
+  const unsigned ways = _config.ways;
+  uint64 line = addr >> _line_shift;
+  unsigned set = (unsigned) (line & _set_mask);
+  uint64 tag = line >> _set_shift;
+
+  // compare all ways of the set
+  const uint64* t = &_tags[set * ways];
+  unsigned match = 0;
+  for (unsigned w=0; w < ways; w++)
+    match |= (unsigned) (t[w] == tag) << w;
+  match &= _valid[set];
+
+  unsigned latency = _config.hit_latency;
+  bool write_through = _config.write_policy == CACHE_WRITE_THROUGH;
+
+  if (write) {
+    _stats.writes++;
+    if (write_through)
+      latency += _config.write_through_penalty;
+  } else
+    _stats.reads++;
+
+  unsigned way;
+  if (match) {
+    way = 0;
+    while (!((match >> way) & 1))
+      way++;
+  } else {
+    if (write)
+      _stats.write_misses++;
+    else
+      _stats.read_misses++;
+
+    // write-through caches do not allocate on write misses
+    if (write && write_through) {
+      _stats.cycles += latency;
+      return latency;
+    }
+
+    way = victim(set);
+    unsigned bit = 1u << way;
+    if (_dirty[set] & bit) {
+      _stats.writebacks++;
+      latency += _config.writeback_penalty;
+    }
+    latency += _config.miss_penalty;
+    _tags[set * ways + way] = tag;
+    _valid[set] |= bit;
+    _dirty[set] &= ~bit;
+  }
+
+  if (write && !write_through)
+    _dirty[set] |= 1u << way;
+
+  touch(set, way);
+  _stats.cycles += latency;
+  return latency;
+}
+
+// marks "way" as the most recently used one of "set"
+
+void
+cache_model::touch(unsigned set, unsigned way)
+{
+  if (_config.replacement == CACHE_LRU) {
+    _stamp[set * _config.ways + way] = ++_now;
+    return;
+  }
+
+  // tree pseudo-LRU: node n has children 2n and 2n+1, the leaves
+  // are ways + way; each node bit points away from the last use
+  unsigned& bits = _plru[set];
+  unsigned n = _config.ways + way;
+  while (n > 1) {
+    unsigned parent = n >> 1;
+    if (n & 1)
+      bits &= ~(1u << parent);    // used the right half: point left
+    else
+      bits |= 1u << parent;
+    n = parent;
+  }
+}
+
+unsigned
+cache_model::victim(unsigned set) const
+{
+  const unsigned ways = _config.ways;
+
+  // an invalid way if there is one
+  unsigned invalid = ~_valid[set] & (unsigned) (((uint64) 1 << ways) - 1);
+  if (invalid) {
+    unsigned w = 0;
+    while (!((invalid >> w) & 1))
+      w++;
+    return w;
+  }
+
+  if (_config.replacement == CACHE_LRU) {
+    const uint64* s = &_stamp[set * ways];
+    unsigned w = 0;
+    for (unsigned i=1; i < ways; i++)
+      if (s[i] < s[w])
+        w = i;
+    return w;
+  }
+
+  unsigned bits = _plru[set];
+  unsigned n = 1;
+  while (n < ways)
+    n = 2 * n + ((bits >> n) & 1);
+  return n - ways;
+}
+
+void
+cache_model::report(ostream& os) const
+{
+  const cache_stats& s = _stats;
+  uint64 accesses = s.reads + s.writes;
+
+  os << _config.size << " byte " << _config.ways << "-way cache, "
+     << _sets << " sets of " << _config.line_size << " byte lines, "
+     << (_config.replacement == CACHE_LRU ? "LRU" : "pseudo-LRU") << ", "
+     << (_config.write_policy == CACHE_WRITE_BACK ? "write-back"
+                                                 : "write-through") << endl;
+  os << "  reads:  " << s.reads << ", misses " << s.read_misses << endl;
+  os << "  writes: " << s.writes << ", misses " << s.write_misses << endl;
+  os << "  writebacks: " << s.writebacks << endl;
+  if (accesses > 0)
+    os << "  hit rate " << 100.0 * (accesses - s.read_misses - s.write_misses)
+                           / accesses
+       << "%, " << s.cycles << " cycles, "
+       << (double) s.cycles / accesses << " cycles per access" << endl;
+}
@@ -0,0 +1,151 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <systemc.h>
+#include <vector>
+
+// Configuration of a cache_model. "size" and "line_size" are in
+// bytes; size / (ways * line_size) gives the number of sets. Line
+// size and number of sets must be powers of two, ways at most 32
+// (and a power of two for pseudo-LRU). Latencies are in cycles:
+//   hit_latency - every access
+//   miss_penalty - added for fetching a line from memory
+//   writeback_penalty - added for writing back a dirty victim line
+//   write_through_penalty - added for every write when the cache
+//     is write-through
+// A write-back cache allocates on write misses, a write-through
+// cache does not.
+//
+// cache_config(size) accepts any size: fit() shrinks the geometry
+// to a legal one of at most "size" bytes (see there). cache_model
+// fits the configuration it is given in the same way.
+
+enum cache_replacement { CACHE_LRU, CACHE_PLRU };
+enum cache_write_policy { CACHE_WRITE_BACK, CACHE_WRITE_THROUGH };
+
+struct cache_config {
+  unsigned size;
+  unsigned ways;
+  unsigned line_size;
+  cache_replacement replacement;
+  cache_write_policy write_policy;
+  unsigned hit_latency;
+  unsigned miss_penalty;
+  unsigned writeback_penalty;
+  unsigned write_through_penalty;
+
+  cache_config(unsigned size_ = 1024)
+    : size(size_), ways(4), line_size(32), replacement(CACHE_LRU),
+      write_policy(CACHE_WRITE_BACK), hit_latency(1), miss_penalty(20),
+      writeback_penalty(20), write_through_penalty(20) { fit(); }
+
+  // Makes the geometry legal: a cache of fewer than "ways" lines
+  // gets fewer ways (a power of two for pseudo-LRU), one smaller
+  // than a line a shorter line, and the number of sets is rounded
+  // down to a power of two, as is "line_size". "size" becomes the
+  // size actually modelled, which is at least one line of one byte.
+  void fit() {
+    if (size == 0)
+      size = 1;
+    line_size = floor_pow2(line_size);
+    while (line_size > size)
+      line_size >>= 1;
+    unsigned lines = size / line_size;
+    if (ways > lines)
+      ways = lines;
+    if (ways > 32)
+      ways = 32;
+    if (ways == 0)
+      ways = 1;
+    if (replacement == CACHE_PLRU)
+      ways = floor_pow2(ways);
+    size = floor_pow2(lines / ways) * ways * line_size;
+  }
+
+  static unsigned floor_pow2(unsigned n) {
+    unsigned p = 1;
+    while (p <= n / 2)
+      p <<= 1;
+    return p;
+  }
+};
+
+struct cache_stats {
+  uint64 reads, read_misses;
+  uint64 writes, write_misses;
+  uint64 writebacks;
+  uint64 cycles;    // sum of all access latencies
+
+  cache_stats() : reads(0), read_misses(0), writes(0), write_misses(0),
+                  writebacks(0), cycles(0) {}
+};
+
+// cache_model: tags, state and replacement of a set-associative
+// cache (no data). access() returns the latency of an access.
+// config() is the fitted configuration, see cache_config::fit().
+//
+// The tags of a set are stored contiguously, apart from the valid
+// and dirty bits, which are one bit mask per set; a lookup compares
+// the address tag with all ways of the set in a loop without
+// branches, which the compiler can vectorize.
+
+class cache_model
+{
+public:
+  cache_model(const cache_config& config);
+
+  unsigned access(uint64 addr, bool write);
+
+  void invalidate();
+
+  const cache_config& config() const { return _config; }
+  unsigned sets() const { return _sets; }
+  const cache_stats& stats() const { return _stats; }
+
+  void report(ostream& os) const;
+
+private:
+  cache_config _config;
+  unsigned _sets, _line_shift, _set_shift;
+  uint64 _set_mask;
+
+  std::vector<uint64> _tags;      // _tags[set * ways + way]
+  std::vector<unsigned> _valid;   // one bit per way
+  std::vector<unsigned> _dirty;
+  std::vector<uint64> _stamp;     // LRU: time of last use, per way
+  std::vector<unsigned> _plru;    // PLRU: tree bits, per set
+  uint64 _now;
+
+  cache_stats _stats;
+
+  void touch(unsigned set, unsigned way);
+  unsigned victim(unsigned set) const;
+};
+
+#endif
@@ -32,20 +32,314 @@
 // This ".cpp" file is compiled, and only the ".o"
 // is provided to the customer
 
+// risc_core: architectural state and interpreter of one core.
+//
+// Instructions are executed from a decoded-instruction cache with
+// an entry per code address. An entry holds the handler of the
+// instruction and its operands; every entry starts out as "decode",
+// which decodes the instruction on its first execution and then
+// replaces itself. Entry "n" past the end of the code always halts,
+// and jumps out of the code go there.
+
+template <unsigned W> class risc_core
+{
+public:
+  struct decoded;
+  typedef void (*handler)(risc_core&, const decoded&);
+
+  struct decoded {
+    handler exec;
+    unsigned rd, rs1, rs2;
+    uint64 imm;
+  };
+
+  static uint64 mask() { return ~(uint64) 0 >> (64 - W); }
+
+  static int64 sext(uint64 v, unsigned bits) {
+    return (int64) (v << (64 - bits)) >> (64 - bits);
+  }
+
+  risc_core(cache_model& cache)
+    : _cache(cache), _pc(0), _halted(false), _cycles(0), _instructions(0),
+      _stored(false), _store_addr(0), _store_data(0)
+  {
+    for (unsigned i=0; i < 16; i++)
+      _r[i] = 0;
+    _dmem.resize(1 << (W < 16 ? W : 16), 0);
+    load(0, 0);
+  }
+
+  void load(const unsigned* code, unsigned n) {
+    _imem.assign(code, code + n);
+    decoded d = { exec_decode, 0, 0, 0, 0 };
+    _decoded.assign(n + 1, d);
+    _decoded[n].exec = exec_halt;
+    _pc = 0;
+    _halted = false;
+  }
+
+  // runs for at least "budget" cycles unless the core halts;
+  // returns the cycles used
+  uint64 run(uint64 budget) {
+    uint64 start = _cycles, end = _cycles + budget;
+    _stored = false;
+    while (_cycles < end && !_halted) {
+      const decoded& d = _decoded[_pc];
+      d.exec(*this, d);
+    }
+    return _cycles - start;
+  }
+
+  uint64 _r[16];
+  std::vector<uint64> _dmem;
+  cache_model& _cache;
+  unsigned _pc;
+  bool _halted;
+  uint64 _cycles, _instructions;
+
+  // last store of the current run()
+  bool _stored;
+  uint64 _store_addr, _store_data;
+
+private:
+  std::vector<unsigned> _imem;
+  std::vector<decoded> _decoded;
+
+  void next(unsigned cycles = 1) {
+    _pc++;
+    _cycles += cycles;
+    _instructions++;
+  }
+
+  void jump(uint64 target) {
+    _pc = target < _imem.size() ? (unsigned) target : _imem.size();
+    _cycles++;
+    _instructions++;
+  }
+
+  unsigned data_index(uint64 addr) const {
+    return (unsigned) (addr & (_dmem.size() - 1));
+  }
+
+  // the cache sees byte addresses
+  unsigned data_access(unsigned index, bool write) {
+    return _cache.access((uint64) index * (W / 8), write);
+  }
+
+  static void exec_decode(risc_core& c, const decoded&);
+  static void exec_halt(risc_core& c, const decoded&) { c._halted = true; }
+  static void exec_nop(risc_core& c, const decoded&) { c.next(); }
+
+#define RISC_ALU(name, expr) \
+  static void exec_##name(risc_core& c, const decoded& d) { \
+    uint64 a = c._r[d.rs1], b = c._r[d.rs2]; \
+    c._r[d.rd] = (expr) & mask(); \
+    c.next(); \
+  } \
+  static void exec_##name##i(risc_core& c, const decoded& d) { \
+    uint64 a = c._r[d.rs1], b = d.imm; \
+    c._r[d.rd] = (expr) & mask(); \
+    c.next(); \
+  }
+
+  RISC_ALU(add, a + b)
+  RISC_ALU(and, a & b)
+  RISC_ALU(or,  a | b)
+  RISC_ALU(xor, a ^ b)
+  RISC_ALU(shl, b < W ? a << b : 0)
+  RISC_ALU(shr, b < W ? a >> b : 0)
+  RISC_ALU(slt, sext(a, W) < sext(b, W))
+  RISC_ALU(sub, a - b)
+  RISC_ALU(sltu, a < b)
+  RISC_ALU(mul, a * b)
+#undef RISC_ALU
+
+  static void exec_li(risc_core& c, const decoded& d) {
+    c._r[d.rd] = d.imm;
+    c.next();
+  }
+
+  static void exec_ld(risc_core& c, const decoded& d) {
+    unsigned i = c.data_index(c._r[d.rs1] + d.imm);
+    unsigned latency = c.data_access(i, false);
+    c._r[d.rd] = c._dmem[i];
+    c._r[0] = 0;
+    c.next(latency);
+  }
+
+  static void exec_st(risc_core& c, const decoded& d) {
+    unsigned i = c.data_index(c._r[d.rs1] + d.imm);
+    unsigned latency = c.data_access(i, true);
+    c._dmem[i] = c._r[d.rs2];
+    c._stored = true;
+    c._store_addr = i;
+    c._store_data = c._r[d.rs2];
+    c.next(latency);
+  }
+
+#define RISC_BRANCH(name, cond) \
+  static void exec_##name(risc_core& c, const decoded& d) { \
+    uint64 a = c._r[d.rs1], b = c._r[d.rs2]; \
+    if (cond) \
+      c.jump(c._pc + d.imm); \
+    else \
+      c.next(); \
+  }
+
+  RISC_BRANCH(beq, a == b)
+  RISC_BRANCH(bne, a != b)
+  RISC_BRANCH(blt, sext(a, W) < sext(b, W))
+  RISC_BRANCH(bltu, a < b)
+#undef RISC_BRANCH
+
+  // link register written before the jump, so "rd" may be "rs1"
+  static void exec_jal(risc_core& c, const decoded& d) {
+    uint64 target = c._pc + d.imm;
+    c._r[d.rd] = (c._pc + 1) & mask();
+    c._r[0] = 0;
+    c.jump(target);
+  }
+
+  static void exec_jalr(risc_core& c, const decoded& d) {
+    uint64 target = (c._r[d.rs1] + d.imm) & mask();
+    c._r[d.rd] = (c._pc + 1) & mask();
+    c._r[0] = 0;
+    c.jump(target);
+  }
+};
+
+template <unsigned W>
+void risc_core<W>::exec_decode(risc_core& c, const decoded&)
+{
+  static const handler handlers[RISC_OPS] = {
+    exec_add, exec_sub, exec_and, exec_or, exec_xor,
+    exec_shl, exec_shr, exec_slt, exec_sltu, exec_mul,
+    exec_addi, exec_andi, exec_ori, exec_xori,
+    exec_shli, exec_shri, exec_slti, exec_li,
+    exec_ld, exec_st,
+    exec_beq, exec_bne, exec_blt, exec_bltu,
+    exec_jal, exec_jalr, exec_halt
+  };
+
+  unsigned insn = c._imem[c._pc];
+  unsigned op = insn >> 26;
+  decoded& d = c._decoded[c._pc];
+
+  d.rd = (insn >> 22) & 15;
+  d.rs1 = (insn >> 18) & 15;
+  d.rs2 = (insn >> 14) & 15;
+  if (op == RISC_LI || op == RISC_JAL)
+    d.imm = (uint64) sext(insn & 0x3fffff, 22);
+  else
+    d.imm = (uint64) sext(insn & 0x3fff, 14);
+
+  if (op >= RISC_OPS)
+    d.exec = exec_halt;         // illegal instruction
+  else if (d.rd == 0 && op <= RISC_LI)
+    d.exec = exec_nop;          // result discarded, r0 stays 0
+  else
+    d.exec = handlers[op];
+
+  // immediates that end up in registers are W-bit values; branch
+  // offsets and load/store displacements are added as they are
+  if (op <= RISC_LI || op == RISC_JALR)
+    d.imm &= mask();
+
+  d.exec(c, d);
+}
+
 template <unsigned W>
 cpu<W>::cpu(sc_module_name nm, unsigned cache_size) :
-  sc_module(nm), _cache_size(cache_size)
+  sc_module(nm), _cache(cache_config(cache_size))
 {
+   init();
+}
+
+template <unsigned W>
+cpu<W>::cpu(sc_module_name nm, const cache_config& config) :
+  sc_module(nm), _cache(config)
+{
+   init();
+}
+
+template <unsigned W>
+void cpu<W>::init()
+{
+   _core = new risc_core<W>(_cache);
+   _quantum = 100;
+   _edges = 0;
+
    SC_METHOD(main);
    sensitive << clock.pos();
+   dont_initialize();
+}
+
+template <unsigned W>
+cpu<W>::~cpu()
+{
+   delete _core;
+}
+
+template <unsigned W>
+void cpu<W>::load_program(const unsigned* code, unsigned n)
+{
+   bool halted = _core->_halted;
+   _core->load(code, n);
+   if (halted)
+     _restart.notify(SC_ZERO_TIME);
+}
+
+template <unsigned W>
+void cpu<W>::set_quantum(unsigned cycles)
+{
+   _quantum = cycles > 0 ? cycles : 1;
+}
+
+template <unsigned W>
+bool cpu<W>::halted() const { return _core->_halted; }
+
+template <unsigned W>
+uint64 cpu<W>::reg(unsigned r) const { return _core->_r[r & 15]; }
+
+template <unsigned W>
+uint64 cpu<W>::memory(unsigned addr) const
+{
+   return _core->_dmem[addr & (_core->_dmem.size() - 1)];
 }
 
+template <unsigned W>
+uint64 cpu<W>::instructions() const { return _core->_instructions; }
+
+template <unsigned W>
+uint64 cpu<W>::cycles() const { return _core->_cycles; }
+
+// The first two rising clock edges give the clock period. From then
+// on every activation runs the core for a quantum of cycles, and the
+// next one is when simulated time has caught up with the core. A
+// halted core is activated again by load_program().
+
 template <unsigned W>
 void cpu<W>::main()
 {
-   static int i;
-   addr = i++;
-   data = 10 + i;
+   if (_edges < 2) {
+     if (_edges++ == 0) {
+       _first_edge = sc_time_stamp();
+       return;
+     }
+     _period = sc_time_stamp() - _first_edge;
+   }
+
+   uint64 used = _core->run(_quantum);
+
+   if (_core->_stored) {
+     addr = _core->_store_addr;
+     data = _core->_store_data;
+   }
+
+   if (_core->_halted)
+     next_trigger(_restart);
+   else
+     next_trigger(_period * (double) used);
 }
 
 // explicitly instantiate cpu for 16, 32, 64 bit bus sizes:
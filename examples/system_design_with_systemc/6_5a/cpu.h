@@ -31,6 +31,16 @@
 // This is the header file provided to customer
 
 #include <systemc.h>
+#include "cache.h"
+#include "risc_isa.h"
+
+template <unsigned W> class risc_core;
+
+// cpu: an instruction-set simulator of the RISC in risc_isa.h, with
+// a data cache. The core runs ahead of simulated time by up to a
+// quantum of clock cycles per activation and then waits for time
+// to catch up. The last store of a quantum is shown on "addr" and
+// "data" when the quantum starts, so up to a quantum early.
 
 template <unsigned W> class cpu : public sc_module
 {
@@ -41,11 +51,35 @@ public:
 
   SC_HAS_PROCESS(cpu);
   cpu(sc_module_name nm, unsigned cache_size);
+  cpu(sc_module_name nm, const cache_config& config);
+  ~cpu();
 
   void main();
 
-private:
-  unsigned _cache_size;
-};
+  // loads "n" instructions at address 0 of the code memory; the
+  // core starts them at its next activation, and a halted core is
+  // restarted one delta cycle later. Registers and data memory keep
+  // their values.
+  void load_program(const unsigned* code, unsigned n);
+
+  // cycles the core may run ahead of simulated time (default 100)
+  void set_quantum(unsigned cycles);
 
+  bool halted() const;
+  uint64 reg(unsigned r) const;
+  uint64 memory(unsigned addr) const;
+  uint64 instructions() const;
+  uint64 cycles() const;
 
+  const cache_model& cache() const { return _cache; }
+
+private:
+  cache_model _cache;
+  risc_core<W>* _core;
+  unsigned _quantum;
+  unsigned _edges;        // clock edges seen while measuring the period
+  sc_time _period, _first_edge;
+  sc_event _restart;     // notified when a halted core gets a program
+
+  void init();
+};
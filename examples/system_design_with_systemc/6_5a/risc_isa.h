@@ -0,0 +1,76 @@
+
+//****************************************************************************
+//****************************************************************************
+//
+// Copyright (c) 2002 Thorsten Groetker, Stan Liao, Grant Martin, Stuart Swan
+//
+// Permission is hereby granted to use, modify, and distribute this source
+// code in any way as long as this entire copyright notice is retained
+// in unmodified form within the source code.
+//
+// This software is distributed on an "AS IS" basis, without warranty
+// of any kind, either express or implied.
+//
+// This source code is from the book "System Design with SystemC".
+// For detailed discussion on this example, see the relevant section
+// within the "System Design with SystemC" book.
+//
+// To obtain the book and find additional source code downloads, etc., visit
+//     www.systemc.org 
+// Look in the "Products & Solutions" -> "SystemC Books". Then look at the
+// entry for "System Design with SystemC".
+//
+//****************************************************************************
+//****************************************************************************
+
+
+#ifndef RISC_ISA_H
+#define RISC_ISA_H
+
+// Instruction set of cpu<W>: a small load/store RISC with 16
+// registers of W bits (r0 is always zero), word-addressed code and
+// data memories, and 32-bit instructions whatever W is.
+//
+// Instruction formats (bit 31 on the left):
+//   | op:6 | rd:4 | rs1:4 | rs2:4 | imm:14 |    all but LI and JAL
+//   | op:6 | rd:4 | imm:22                 |    LI, JAL
+// Immediates are sign-extended. Branch and JAL offsets are in
+// instructions, relative to the branch itself.
+//
+//   ADD SUB AND OR XOR SHL SHR SLT SLTU MUL   rd = rs1 op rs2
+//   ADDI ANDI ORI XORI SHLI SHRI SLTI         rd = rs1 op imm
+//   LI      rd = imm
+//   LD      rd = mem[rs1 + imm]
+//   ST      mem[rs1 + imm] = rs2
+//   BEQ BNE BLT BLTU   if (rs1 cond rs2) pc += imm
+//   JAL     rd = pc + 1, pc += imm
+//   JALR    rd = pc + 1, pc = rs1 + imm
+//   HALT    stops the core
+//
+// SHR is a logical shift; SLT and BLT compare signed values.
+
+enum risc_op {
+  RISC_ADD, RISC_SUB, RISC_AND, RISC_OR, RISC_XOR,
+  RISC_SHL, RISC_SHR, RISC_SLT, RISC_SLTU, RISC_MUL,
+  RISC_ADDI, RISC_ANDI, RISC_ORI, RISC_XORI,
+  RISC_SHLI, RISC_SHRI, RISC_SLTI, RISC_LI,
+  RISC_LD, RISC_ST,
+  RISC_BEQ, RISC_BNE, RISC_BLT, RISC_BLTU,
+  RISC_JAL, RISC_JALR, RISC_HALT,
+  RISC_OPS
+};
+
+inline unsigned
+risc_encode(risc_op op, unsigned rd, unsigned rs1, unsigned rs2, int imm = 0)
+{
+  return ((unsigned) op << 26) | ((rd & 15) << 22) | ((rs1 & 15) << 18) |
+         ((rs2 & 15) << 14) | ((unsigned) imm & 0x3fff);
+}
+
+inline unsigned
+risc_encode_long(risc_op op, unsigned rd, int imm)
+{
+  return ((unsigned) op << 26) | ((rd & 15) << 22) | ((unsigned) imm & 0x3fffff);
+}
+
+#endif
@@ -27,6 +27,8 @@
 
 
 
+#include <time.h>
+#include <list>
 #include "cpu.h"
 
 template <class T> class response : public sc_module {
@@ -45,23 +47,358 @@ public:
   }
 };
 
+// Reference for the LRU cache_model: per set a list of the cached
+// lines, most recently used first, with the same latencies.
+
+class lru_reference
+{
+public:
+  lru_reference(const cache_config& c)
+    : _c(c), _sets(c.size / (c.ways * c.line_size)), _lines(_sets) {}
+
+  unsigned access(uint64 addr, bool write) {
+    uint64 line = addr / _c.line_size;
+    std::list<entry>& set = _lines[line % _sets];
+    uint64 tag = line / _sets;
+    bool write_through = _c.write_policy == CACHE_WRITE_THROUGH;
+
+    unsigned latency = _c.hit_latency;
+    if (write && write_through)
+      latency += _c.write_through_penalty;
+
+    std::list<entry>::iterator i = set.begin();
+    while (i != set.end() && i->tag != tag)
+      i++;
+    entry e = { tag, false };
+    if (i != set.end()) {
+      e = *i;
+      set.erase(i);
+    } else {
+      if (write && write_through)
+        return latency;
+      if (set.size() == _c.ways) {
+        if (set.back().dirty)
+          latency += _c.writeback_penalty;
+        set.pop_back();
+      }
+      latency += _c.miss_penalty;
+    }
+    if (write && !write_through)
+      e.dirty = true;
+    set.push_front(e);
+    return latency;
+  }
+
+private:
+  struct entry {
+    uint64 tag;
+    bool dirty;
+  };
+
+  cache_config _c;
+  unsigned _sets;
+  std::vector<std::list<entry> > _lines;
+};
+
+// Reference for the pseudo-LRU cache_model: the lines of a set in
+// an array of ways with the time of their last use. The victim is
+// the first invalid way, or else found by halving the ways of the
+// set, keeping the half whose last use is older, until one is left;
+// that is the way the bits of the PLRU tree point to.
+
+class plru_reference
+{
+public:
+  plru_reference(const cache_config& c)
+    : _c(c), _sets(c.size / (c.ways * c.line_size)),
+      _lines(_sets * c.ways), _now(0) {}
+
+  unsigned access(uint64 addr, bool write) {
+    uint64 line = addr / _c.line_size;
+    entry* set = &_lines[(line % _sets) * _c.ways];
+    uint64 tag = line / _sets;
+    bool write_through = _c.write_policy == CACHE_WRITE_THROUGH;
+
+    unsigned latency = _c.hit_latency;
+    if (write && write_through)
+      latency += _c.write_through_penalty;
+
+    unsigned w = 0;
+    while (w < _c.ways && !(set[w].valid && set[w].tag == tag))
+      w++;
+    if (w == _c.ways) {
+      if (write && write_through)
+        return latency;
+      w = victim(set);
+      if (set[w].valid && set[w].dirty)
+        latency += _c.writeback_penalty;
+      set[w].valid = true;
+      set[w].tag = tag;
+      set[w].dirty = false;
+      latency += _c.miss_penalty;
+    }
+    if (write && !write_through)
+      set[w].dirty = true;
+    set[w].used = ++_now;
+    return latency;
+  }
+
+private:
+  struct entry {
+    bool valid, dirty;
+    uint64 tag, used;
+
+    entry() : valid(false), dirty(false), tag(0), used(0) {}
+  };
+
+  cache_config _c;
+  unsigned _sets;
+  std::vector<entry> _lines;
+  uint64 _now;
+
+  unsigned victim(const entry* set) const {
+    unsigned w, lo = 0, n = _c.ways;
+    for (w=0; w < n; w++)
+      if (!set[w].valid)
+        return w;
+    while (n > 1) {
+      n /= 2;
+      if (last_use(set, lo, n) > last_use(set, lo + n, n))
+        lo += n;
+    }
+    return lo;
+  }
+
+  static uint64 last_use(const entry* set, unsigned lo, unsigned n) {
+    uint64 t = 0;
+    for (unsigned w=lo; w < lo + n; w++)
+      if (set[w].used > t)
+        t = set[w].used;
+    return t;
+  }
+};
+
+// Number of accesses of a random pattern for which "cache" and
+// the reference "ref" give different latencies
+
+template <class R>
+unsigned mismatches(cache_model& cache, R& ref, unsigned accesses)
+{
+  unsigned seed = 1, n, count = 0;
+  for (n=0; n < accesses; n++) {
+    seed = seed * 1103515245 + 12345;
+    uint64 addr = (seed >> 8) % (4 * cache.config().size);
+    bool write = (seed >> 28) & 1;
+    if (cache.access(addr, write) != ref.access(addr, write))
+      count++;
+  }
+  return count;
+}
+
+// Compares cache_model with lru_reference and plru_reference on
+// every access of a random pattern, for 1 to 8 ways and both write
+// policies, and measures the access rate of cache_model on a
+// miss-heavy pattern. Returns the number of failures.
+
+int check_cache(unsigned accesses)
+{
+  int errors = 0;
+
+  // any size gives a legal geometry of at most that size
+  const unsigned sizes[] = { 0, 1, 100, 1000, 1024, 5000 };
+  for (unsigned k=0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+    cache_config config(sizes[k]);
+    cache_model c(config);
+    if (c.config().size > sizes[k] && sizes[k] > 0) {
+      cout << "cache of " << sizes[k] << " bytes is " << c.config().size
+           << endl;
+      errors++;
+    }
+  }
+
+  for (unsigned ways=1; ways <= 8; ways *= 2)
+    for (int wt=0; wt < 2; wt++)
+      for (int plru=0; plru < 2; plru++) {
+        cache_config config(1024);
+        config.ways = ways;
+        config.write_policy = wt ? CACHE_WRITE_THROUGH : CACHE_WRITE_BACK;
+        config.replacement = plru ? CACHE_PLRU : CACHE_LRU;
+        cache_model c(config);
+
+        unsigned m;
+        if (plru) {
+          plru_reference ref(config);
+          m = mismatches(c, ref, accesses);
+        } else {
+          lru_reference ref(config);
+          m = mismatches(c, ref, accesses);
+        }
+        if (m) {
+          cout << ways << "-way " << (wt ? "write-through" : "write-back")
+               << (plru ? " pseudo-LRU" : " LRU") << " cache: " << m
+               << " of " << accesses << " latencies differ from the reference"
+               << endl;
+          errors++;
+        }
+      }
+
+  // every access misses: 64 lines in a row map to one set of 4 ways
+  cache_model c((cache_config()));
+  clock_t t = clock();
+  for (unsigned n=0; n < accesses; n++)
+    c.access((uint64) (n % 64) * c.sets() * c.config().line_size, false);
+  double seconds = (double) (clock() - t) / CLOCKS_PER_SEC;
+  cout << "cache check: " << errors << " errors";
+  if (seconds > 0)
+    cout << ", " << accesses / seconds << " accesses/s when missing";
+  cout << endl;
+  return errors;
+}
+
+// isa_program: a program for cpu<w> that exercises SUB, the shifts,
+// SLT against SLTU, the signed BLT, JAL and JALR, writes to r0 and
+// W-bit wrap-around. Its results are checked by check_isa(). Returns
+// the number of instructions written to "code".
+
+unsigned isa_program(unsigned w, unsigned* code)
+{
+  unsigned n = 0;
+  code[n++] = risc_encode_long(RISC_LI, 13, 0);
+  code[n++] = risc_encode_long(RISC_LI, 1, -1);
+  code[n++] = risc_encode_long(RISC_LI, 2, 1);
+  code[n++] = risc_encode(RISC_SUB, 3, 2, 1);         // 1 - -1
+  code[n++] = risc_encode(RISC_SUB, 4, 0, 2);         // 0 - 1
+  code[n++] = risc_encode_long(RISC_LI, 6, w - 1);
+  code[n++] = risc_encode(RISC_SHL, 5, 2, 6);         // sign bit
+  code[n++] = risc_encode(RISC_SHR, 7, 5, 6);         // logical: 1
+  code[n++] = risc_encode(RISC_SHRI, 8, 1, 0, w - 1); // logical: 1
+  code[n++] = risc_encode(RISC_SLT, 9, 5, 2);         // negative < 1
+  code[n++] = risc_encode(RISC_SLTU, 10, 5, 2);       // 2^(w-1) > 1
+  code[n++] = risc_encode(RISC_SLTI, 11, 1, 0, 0);    // -1 < 0
+  code[n++] = risc_encode(RISC_ADD, 0, 2, 2);         // r0 stays 0
+  code[n++] = risc_encode(RISC_ADD, 14, 1, 2);        // wraps to 0
+  code[n++] = risc_encode(RISC_MUL, 15, 1, 1);        // -1 * -1
+  code[n++] = risc_encode(RISC_BLT, 0, 5, 2, 2);      // taken
+  code[n++] = risc_encode(RISC_HALT, 0, 0, 0);
+  code[n++] = risc_encode(RISC_BLTU, 0, 5, 2, 2);     // not taken
+  code[n++] = risc_encode(RISC_ADDI, 13, 0, 0, 5);
+  code[n++] = risc_encode_long(RISC_JAL, 12, 3);      // to "sub"
+  code[n++] = risc_encode(RISC_ST, 0, 0, 12, 1);      // mem[1] = link
+  code[n++] = risc_encode(RISC_HALT, 0, 0, 0);
+  code[n++] = risc_encode(RISC_ST, 0, 0, 13, 0);      // sub: mem[0] = 5
+  code[n++] = risc_encode(RISC_LD, 0, 0, 0, 0);       // r0 stays 0
+  code[n++] = risc_encode(RISC_JALR, 0, 12, 0, 0);    // return
+  return n;
+}
+
+// check_isa: compares the state of a cpu that ran isa_program()
+//   with the expected one; returns the number of differences
+
+template <unsigned W> int check_isa(const cpu<W>& c)
+{
+  const uint64 mask = ~(uint64) 0 >> (64 - W);
+  const uint64 sign = (uint64) 1 << (W - 1);
+  const uint64 expected[16] = {
+    0, mask, 1, 2, mask, sign, W - 1, 1, 1, 1, 0, 1, 20, 5, 0, 1
+  };
+
+  int errors = 0;
+  if (!c.halted()) {
+    cout << c.name() << ": not halted" << endl;
+    errors++;
+  }
+  for (unsigned r=0; r < 16; r++)
+    if (c.reg(r) != expected[r]) {
+      cout << c.name() << ": r" << r << " = " << c.reg(r)
+           << ", expected " << expected[r] << endl;
+      errors++;
+    }
+  if (c.memory(0) != 5 || c.memory(1) != 20) {
+    cout << c.name() << ": memory " << c.memory(0) << " " << c.memory(1)
+         << ", expected 5 20" << endl;
+    errors++;
+  }
+  return errors;
+}
+
 int sc_main(int argc, char *argv[])
 {
+  int errors = check_cache(200000);
+
   const int W = 32;
   sc_signal<sc_uint<W> > address;
   sc_signal<sc_uint<W> > data;
   sc_clock clk("clk", 1, SC_NS);
   
+  // sums 0 .. 99, storing the partial sums from address 0x100 on
+  // and the total at address 0
+  const unsigned program[] = {
+    risc_encode_long(RISC_LI, 1, 0),
+    risc_encode_long(RISC_LI, 2, 100),
+    risc_encode_long(RISC_LI, 3, 0),
+    risc_encode(RISC_ADD, 3, 3, 1),           // loop:
+    risc_encode(RISC_ST, 0, 1, 3, 0x100),
+    risc_encode(RISC_ADDI, 1, 1, 0, 1),
+    risc_encode(RISC_BLT, 0, 1, 2, -3),       // to loop
+    risc_encode(RISC_ST, 0, 0, 3, 0),
+    risc_encode(RISC_HALT, 0, 0, 0)
+  };
+
   cpu<W> cpu1("cpu1", 256);
   cpu1.clock(clk);
   cpu1.addr(address);
   cpu1.data(data);
+  cpu1.load_program(program, sizeof(program) / sizeof(program[0]));
 
   response<sc_uint<W> > resp("resp");
   resp.in(address);
 
-  sc_start(10, SC_NS); 
+  // the same checks at every width
+  unsigned isa[32], n;
+  sc_signal<sc_uint<16> > address16, data16;
+  sc_signal<sc_uint<32> > address32, data32;
+  sc_signal<sc_uint<64> > address64, data64;
+
+  cpu<16> isa16("isa16", 256);
+  isa16.clock(clk);
+  isa16.addr(address16);
+  isa16.data(data16);
+  n = isa_program(16, isa);
+  isa16.load_program(isa, n);
+
+  cpu<32> isa32("isa32", 256);
+  isa32.clock(clk);
+  isa32.addr(address32);
+  isa32.data(data32);
+  n = isa_program(32, isa);
+  isa32.load_program(isa, n);
+
+  cpu<64> isa64("isa64", 256);
+  isa64.clock(clk);
+  isa64.addr(address64);
+  isa64.data(data64);
+  n = isa_program(64, isa);
+  isa64.load_program(isa, n);
+
+  sc_start(2000, SC_NS); 
+  cout << "halted: " << cpu1.halted() << ", sum: " << cpu1.memory(0)
+       << ", " << cpu1.instructions() << " instructions in "
+       << cpu1.cycles() << " cycles" << endl;
+  cpu1.cache().report(cout);
+  if (!cpu1.halted() || cpu1.memory(0) != 4950) {
+    cout << "wrong sum, expected 4950" << endl;
+    errors++;
+  }
+  errors += check_isa(isa16) + check_isa(isa32) + check_isa(isa64);
+
+  // a halted cpu runs the next program it is given
+  n = isa_program(W, isa);
+  cpu1.load_program(isa, n);
+  sc_start(1000, SC_NS);
+  errors += check_isa(cpu1);
+
+  cout << errors << " errors" << endl;
   cout << "ending" << endl << endl;
   cout << endl;
-  return 0;
+  return errors ? 1 : 0;
 }
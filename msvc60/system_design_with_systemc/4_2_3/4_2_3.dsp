@@ -91,6 +91,10 @@ SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\robot.cpp
 
 SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\main.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\robot_levelized.cpp
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -99,6 +103,30 @@ SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\main.cpp
 
 SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\robot.h
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\robot_model.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\robot_levelized.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\fsm_table.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\robot_x64.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\fsm_coverage.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\4_2_3\nat_types.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 
@@ -91,6 +91,10 @@ SOURCE=..\..\..\examples\system_design_with_systemc\6_3_2a\fir_elab_time.cpp
 # Begin Group "Header Files"
 
 # PROP Default_Filter "h;hpp;hxx;hm;inl"
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_3_2a\fir_elab_time.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 
@@ -91,6 +91,22 @@ SOURCE=..\..\..\examples\system_design_with_systemc\6_3_2b\generate_structure.cp
 # Begin Group "Header Files"
 
 # PROP Default_Filter "h;hpp;hxx;hm;inl"
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_3_2b\elab_profile.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_3_2b\clock_domain.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_3_2b\reg_signal.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_3_2b\alloc_count.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 
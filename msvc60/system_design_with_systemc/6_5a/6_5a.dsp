@@ -91,6 +91,10 @@ SOURCE=..\..\..\examples\system_design_with_systemc\6_5a\cpu.cpp
 
 SOURCE=..\..\..\examples\system_design_with_systemc\6_5a\test_exp_instantiate.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_5a\cache.cpp
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -99,6 +103,14 @@ SOURCE=..\..\..\examples\system_design_with_systemc\6_5a\test_exp_instantiate.cp
 
 SOURCE=..\..\..\examples\system_design_with_systemc\6_5a\cpu.h
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_5a\cache.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\examples\system_design_with_systemc\6_5a\risc_isa.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 